@@ -4,6 +4,7 @@
 #include "ship/controller/controldevice/controller/mapping/keyboard/KeyboardScancodes.h"
 #include "FastMouseStateManager.h"
 #include "fast/debug/GfxDebugger.h"
+#include "fast/FrameLimiter.h"
 
 union Gfx;
 #include "interpreter.h"
@@ -78,16 +79,29 @@ class Fast3dWindow : public Ship::Window {
     void SetMaximumFrameLatency(int32_t latency);
     void GetPixelDepthPrepare(float x, float y);
     uint16_t GetPixelDepth(float x, float y);
+    uint16_t GetPixelDepthAsync(float x, float y);
+    void GetPixelDepthBatchAsync(const float* xs, const float* ys, uint16_t* depths, size_t count);
     void SetTextureFilter(FilteringMode filteringMode);
+    GfxFramebufferPoolStats GetFramebufferPoolStats();
     void SetRendererUCode(UcodeHandlers ucode);
     void EnableSRGBMode();
     bool DrawAndRunGraphicsCommands(Gfx* commands, const std::unordered_map<Mtx*, MtxF>& mtxReplacements);
 
+    /**
+     * @brief Returns the frame limiter of the window backend, nullptr if the backend paces frames another way.
+     *
+     * Its settings and jitter histogram belong to the thread that draws frames, which is where GUI windows run.
+     */
+    FrameLimiter* GetFrameLimiter();
+
     std::weak_ptr<Interpreter> GetInterpreterWeak() const;
 
     /** @brief Returns the graphics debugger for this Fast3D window. */
     std::shared_ptr<GfxDebugger> GetGfxDebugger() const;
 
+    /** @brief Returns the binary GBI trace recorder for this Fast3D window. */
+    std::shared_ptr<GfxTraceRecorder> GetGfxTraceRecorder() const;
+
   protected:
     static bool KeyDown(int32_t scancode);
     static bool KeyUp(int32_t scancode);
@@ -101,5 +115,6 @@ class Fast3dWindow : public Ship::Window {
     GfxWindowBackend* mWindowManagerApi;
     std::shared_ptr<Interpreter> mInterpreter = nullptr;
     std::shared_ptr<GfxDebugger> mGfxDebugger;
+    std::shared_ptr<GfxTraceRecorder> mGfxTraceRecorder;
 };
 } // namespace Fast
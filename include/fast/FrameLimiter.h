@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Fast {
+
+// Distribution of how far frame intervals land from the target interval. The outermost buckets also collect
+// everything beyond them.
+class FrameJitterHistogram {
+  public:
+    static constexpr int64_t BUCKET_WIDTH_NS = 100000;
+    // -2.0 ms to +2.0 ms in 0.1 ms steps
+    static constexpr size_t BUCKET_COUNT = 41;
+
+    void Record(int64_t jitterNs);
+    void Reset();
+
+    uint64_t GetCount() const;
+    uint64_t GetBucket(size_t bucket) const;
+    // Jitter in the middle of a bucket
+    static int64_t GetBucketCenter(size_t bucket);
+    static size_t GetBucketIndex(int64_t jitterNs);
+    double GetMean() const;
+    double GetStandardDeviation() const;
+    int64_t GetMaxAbsolute() const;
+
+  private:
+    std::array<uint64_t, BUCKET_COUNT> mBuckets = {};
+    uint64_t mCount = 0;
+    double mSum = 0.0;
+    double mSumOfSquares = 0.0;
+    int64_t mMaxAbsolute = 0;
+};
+
+// Paces frames to a target rate. It sleeps until the spin margin before the deadline and yields the rest of the way,
+// so timer slack and scheduler wake up latency don't delay frames.
+class FrameLimiter {
+  public:
+    FrameLimiter();
+    virtual ~FrameLimiter();
+
+    FrameLimiter(const FrameLimiter&) = delete;
+    FrameLimiter& operator=(const FrameLimiter&) = delete;
+
+    // Blocks until the next frame is due and records how far the interval since the last call was off
+    void Wait(int32_t targetFps);
+
+    // Time before the deadline at which sleeping stops and spinning starts, 0 only sleeps
+    void SetSpinMargin(int64_t marginNs);
+    int64_t GetSpinMargin() const;
+    // Sleep to an absolute deadline with clock_nanosleep(TIMER_ABSTIME) where available, so time spent between
+    // reading the clock and going to sleep does not add up. Relative sleeps are used elsewhere.
+    void SetAbsoluteDeadline(bool absolute);
+    bool IsAbsoluteDeadline() const;
+
+    const FrameJitterHistogram& GetJitterHistogram() const;
+    void ResetJitterHistogram();
+
+    // Monotonic clock the deadlines are measured in
+    static int64_t Now();
+
+  protected:
+    // Clock and sleep the limiter paces with, overridden to test pacing against a simulated clock
+    virtual int64_t ReadClock();
+    virtual void SleepUntil(int64_t deadline, int64_t now);
+
+  private:
+
+    int64_t mSpinMargin;
+    bool mAbsoluteDeadline = true;
+    // Start of the current frame interval
+    int64_t mPreviousDeadline = 0;
+    int64_t mPreviousWake = 0;
+    int32_t mPreviousTargetFps = 0;
+    FrameJitterHistogram mJitter;
+#ifdef _WIN32
+    void* mTimer;
+#endif
+};
+
+} // namespace Fast
@@ -4,6 +4,8 @@
 #include "gfx_rendering_api.h"
 #include "../interpreter.h"
 
+#include <deque>
+
 #ifdef _MSC_VER
 #include <SDL2/SDL.h>
 // #define GL_GLEXT_PROTOTYPES 1
@@ -25,6 +27,11 @@
 #include <SDL2/SDL_opengl.h>
 #endif
 namespace Fast {
+constexpr size_t MAX_POOLED_FRAMEBUFFER_STORAGE = 16;
+// Idle attachments are also limited by size, so a resize drag doesn't keep many full-size or multisampled
+// attachments alive. Attachments larger than this are never pooled.
+constexpr size_t MAX_POOLED_FRAMEBUFFER_BYTES = 64 * 1024 * 1024;
+
 struct ShaderProgram {
     GLuint openglProgramId;
     uint8_t numInputs;
@@ -50,6 +57,24 @@ struct FramebufferOGL {
     GLuint fbo, clrbuf, clrbufMsaa, rbo;
 };
 
+// Shape of a pooled framebuffer attachment. Single-sampled color attachments are textures so they can be sampled,
+// everything else is a renderbuffer.
+struct FramebufferStorageKey {
+    GLenum format;
+    uint32_t width, height;
+    uint32_t msaa_level;
+
+    bool operator==(const FramebufferStorageKey&) const noexcept = default;
+
+    bool IsTexture() const {
+        return format == GL_RGB8 && msaa_level <= 1;
+    }
+
+    size_t GetSizeBytes() const {
+        return (size_t)width * height * msaa_level * 4;
+    }
+};
+
 struct TextureInfo {
     uint16_t width;
     uint16_t height;
@@ -88,6 +113,7 @@ class GfxRenderingAPIOGL final : public GfxRenderingAPI {
     void UpdateFramebufferParameters(int fb_id, uint32_t width, uint32_t height, uint32_t msaa_level,
                                      bool opengl_invertY, bool render_target, bool has_depth_buffer,
                                      bool can_extract_depth) override;
+    GfxFramebufferPoolStats GetFramebufferPoolStats() override;
     void StartDrawToFramebuffer(int fbId, float noiseScale) override;
     void CopyFramebuffer(int fbDstId, int fbSrcId, int srcX0, int srcY0, int srcX1, int srcY1, int dstX0, int dstY0,
                          int dstX1, int dstY1) override;
@@ -97,6 +123,9 @@ class GfxRenderingAPIOGL final : public GfxRenderingAPI {
     void ResolveMSAAColorBuffer(int fbIdTarger, int fbIdSrc) override;
     std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff>
     GetPixelDepth(int fb_id, const std::set<std::pair<float, float>>& coordinates) override;
+    void RequestPixelDepthAsync(int fb_id, const std::set<std::pair<float, float>>& coordinates) override;
+    std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> CollectPixelDepthAsync() override;
+    bool ReadFramebufferToCPUAsync(int fbId, uint32_t width, uint32_t height, uint16_t* rgba16Buf) override;
     void* GetFramebufferTextureId(int fbId) override;
     void SelectTextureFb(int fbId) override;
     void DeleteTexture(uint32_t texId) override;
@@ -109,6 +138,9 @@ class GfxRenderingAPIOGL final : public GfxRenderingAPI {
     void SetUniforms(ShaderProgram* prg) const;
     std::string BuildFsShader(const CCFeatures& cc_features);
     void SetPerDrawUniforms();
+    GLuint AcquireFramebufferStorage(const FramebufferStorageKey& key);
+    void ReleaseFramebufferStorage(const FramebufferStorageKey& key, GLuint name);
+    void GatherPixelDepth(const FramebufferOGL& fb, const std::set<std::pair<float, float>>& coordinates);
 
     std::vector<TextureInfo> textures;
     GLuint mCurrentTextureIds[SHADER_MAX_TEXTURES] = {};
@@ -130,6 +162,9 @@ class GfxRenderingAPIOGL final : public GfxRenderingAPI {
     uint32_t mFrameCount = 0;
 
     std::vector<FramebufferOGL> mFrameBuffers;
+    // Idle framebuffer attachments, oldest first
+    std::deque<std::pair<FramebufferStorageKey, GLuint>> mFramebufferStoragePool;
+    GfxFramebufferPoolStats mFramebufferPoolStats{};
     size_t mCurrentFrameBuffer = 0;
     float mCurrentNoiseScale = 0.0f;
     FilteringMode mCurrentFilterMode = FILTER_THREE_POINT;
@@ -138,6 +173,19 @@ class GfxRenderingAPIOGL final : public GfxRenderingAPI {
     GLuint mPixelDepthRb = 0;
     GLuint mPixelDepthFb = 0;
     size_t mPixelDepthRbSize = 0;
+
+    // Pixel pack buffers for the asynchronous readback paths, each guarded by a fence
+    GLuint mPixelDepthPbo = 0;
+    size_t mPixelDepthPboSize = 0;
+    GLsync mPixelDepthFence = nullptr;
+    std::vector<std::pair<float, float>> mPixelDepthAsyncCoords;
+
+    GLuint mReadbackPbo = 0;
+    size_t mReadbackPboSize = 0;
+    GLsync mReadbackFence = nullptr;
+    int mReadbackFbId = -1;
+    uint32_t mReadbackWidth = 0;
+    uint32_t mReadbackHeight = 0;
 };
 
 } // namespace Fast
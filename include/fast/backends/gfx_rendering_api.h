@@ -2,8 +2,10 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <unordered_map>
 #include <set>
+#include <vector>
 #include "imconfig.h"
 
 namespace Fast {
@@ -27,6 +29,15 @@ struct hash_pair_ff {
     }
 };
 
+// Counters for the render target storage pool of backends that recycle framebuffer attachments
+struct GfxFramebufferPoolStats {
+    size_t hits;        // Attachments served from the pool
+    size_t misses;      // Attachments that had to be allocated
+    size_t evictions;   // Pooled attachments destroyed to keep the pool bounded
+    size_t pooledCount; // Attachments currently idle in the pool
+    size_t pooledBytes; // Approximate GPU memory held by the idle attachments
+};
+
 class GfxRenderingAPI {
   public:
     virtual ~GfxRenderingAPI() = default;
@@ -58,6 +69,9 @@ class GfxRenderingAPI {
     virtual void UpdateFramebufferParameters(int fb_id, uint32_t width, uint32_t height, uint32_t msaa_level,
                                              bool opengl_invertY, bool render_target, bool has_depth_buffer,
                                              bool can_extract_depth) = 0;
+    virtual GfxFramebufferPoolStats GetFramebufferPoolStats() {
+        return {};
+    }
     virtual void StartDrawToFramebuffer(int fbId, float noiseScale) = 0;
     virtual void CopyFramebuffer(int fbDstId, int fbSrcId, int srcX0, int srcY0, int srcX1, int srcY1, int dstX0,
                                  int dstY0, int dstX1, int dstY1) = 0;
@@ -71,6 +85,35 @@ class GfxRenderingAPI {
     virtual void ResolveMSAAColorBuffer(int fbIdTarger, int fbIdSrc) = 0;
     virtual std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff>
     GetPixelDepth(int fb_id, const std::set<std::pair<float, float>>& coordinates) = 0;
+    // Asynchronous depth readback with one frame of latency. RequestPixelDepthAsync queues a readback of the given
+    // coordinates without waiting for the GPU, and CollectPixelDepthAsync returns the values of the previous request
+    // once it has completed. Backends without a staging path fall back to a synchronous read whose results are held
+    // back until the next collect, so callers observe the same latency everywhere. Only the OpenGL backend has a
+    // staging path. On D3D11, Metal and GLES the request still stalls until the GPU has finished the frame.
+    virtual void RequestPixelDepthAsync(int fb_id, const std::set<std::pair<float, float>>& coordinates) {
+        mPixelDepthAsyncResult = GetPixelDepth(fb_id, coordinates);
+    }
+    virtual std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> CollectPixelDepthAsync() {
+        return std::move(mPixelDepthAsyncResult);
+    }
+    // Queues a framebuffer readback and writes the pixels of the previous request into rgba16Buf.
+    // Returns false when no previous data of the requested size is available yet (e.g. on the first call).
+    // Only OpenGL overrides this. The default, used by D3D11 and Metal, still stalls on a synchronous read but holds
+    // its pixels back until the next call, so callers observe the same latency everywhere.
+    virtual bool ReadFramebufferToCPUAsync(int fbId, uint32_t width, uint32_t height, uint16_t* rgba16Buf) {
+        const bool hasData = mFramebufferAsyncFbId == fbId && mFramebufferAsyncWidth == width &&
+                             mFramebufferAsyncHeight == height && !mFramebufferAsyncResult.empty();
+        if (hasData) {
+            std::copy(mFramebufferAsyncResult.begin(), mFramebufferAsyncResult.end(), rgba16Buf);
+        }
+
+        mFramebufferAsyncResult.resize((size_t)width * height);
+        ReadFramebufferToCPU(fbId, width, height, mFramebufferAsyncResult.data());
+        mFramebufferAsyncFbId = fbId;
+        mFramebufferAsyncWidth = width;
+        mFramebufferAsyncHeight = height;
+        return hasData;
+    }
     virtual void* GetFramebufferTextureId(int fbId) = 0;
     virtual void SelectTextureFb(int fbId) = 0;
     virtual void DeleteTexture(uint32_t texId) = 0;
@@ -90,5 +133,10 @@ class GfxRenderingAPI {
     bool mSrgbMode = false;
     float mCurrentPrimDepth = 0.0f;
     bool mPrimDepthDirty = true;
+    std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> mPixelDepthAsyncResult;
+    std::vector<uint16_t> mFramebufferAsyncResult;
+    int mFramebufferAsyncFbId = -1;
+    uint32_t mFramebufferAsyncWidth = 0;
+    uint32_t mFramebufferAsyncHeight = 0;
 };
 } // namespace Fast
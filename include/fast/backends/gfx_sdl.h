@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gfx_window_manager_api.h"
+#include "fast/FrameLimiter.h"
 namespace Fast {
 class GfxWindowBackendSDL2 final : public GfxWindowBackend {
   public:
@@ -40,6 +41,7 @@ class GfxWindowBackendSDL2 final : public GfxWindowBackend {
     bool IsRunning() override;
     void Destroy() override;
     bool IsFullscreen() override;
+    FrameLimiter* GetFrameLimiter() override;
 
   private:
     void SetFullscreenImpl(bool on, bool call_callback);
@@ -50,7 +52,7 @@ class GfxWindowBackendSDL2 final : public GfxWindowBackend {
     void OnKeyup(int scancode) const;
     void OnMouseButtonDown(int btn) const;
     void OnMouseButtonUp(int btn) const;
-    void SyncFramerateWithTime() const;
+    void SyncFramerateWithTime();
 
     SDL_Window* mWnd;
     SDL_Rect mCursorClip;
@@ -59,9 +61,7 @@ class GfxWindowBackendSDL2 final : public GfxWindowBackend {
     int mSdlToLusTable[512];
     float mMouseWheelX = 0.0f;
     float mMouseWheelY = 0.0f;
-#ifdef __OpenBSD__
-    int mBsdTick; // store kern.clockrate's tick (microseconds) to adjust sleep timing
-#endif
+    FrameLimiter mFrameLimiter;
     // OTRTODO: These are redundant. Info can be queried from SDL.
     int mWindowWidth = 640;
     int mWindowHeight = 480;
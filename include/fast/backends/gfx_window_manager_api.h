@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include "ship/window/Window.h"
 namespace Fast {
+class FrameLimiter;
+
 class GfxWindowBackend {
   public:
     virtual ~GfxWindowBackend() = default;
@@ -40,6 +42,10 @@ class GfxWindowBackend {
     virtual bool IsRunning() = 0;
     virtual void Destroy() = 0;
     virtual bool IsFullscreen() = 0;
+    // Paces frames when the backend limits the framerate itself, nullptr otherwise
+    virtual FrameLimiter* GetFrameLimiter() {
+        return nullptr;
+    }
 
   protected:
     void (*mOnFullscreenChanged)(bool isNowFullscreen);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <vector>
 
 namespace Fast {
@@ -19,7 +20,7 @@ class GfxDebugger {
 
     const std::vector<const F3DGfx*>& GetBreakPoint() const;
 
-    bool HasBreakPoint(const std::vector<const F3DGfx*>& path) const;
+    bool HasBreakPoint(std::span<const F3DGfx* const> path) const;
 
     void SetBreakPoint(const std::vector<const F3DGfx*>& bp);
 
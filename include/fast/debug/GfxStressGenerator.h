@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "fast/lus_gbi.h"
+
+namespace Fast {
+
+// Inclusive range a value is drawn from uniformly
+struct GfxStressRange {
+    uint32_t min;
+    uint32_t max;
+};
+
+struct GfxStressTextureFormat {
+    uint8_t fmt; // G_IM_FMT_*
+    uint8_t siz; // G_IM_SIZ_*
+};
+
+struct GfxStressConfig {
+    uint32_t seed = 1;
+    // Number of top level display lists called from the root list
+    uint32_t objectCount = 64;
+    // Maximum depth of G_DL calls below an object and the chance each state change adds a nested call
+    uint32_t maxNestingDepth = 2;
+    float nestingProbability = 0.1f;
+    GfxStressRange stateChangesPerList = { 2, 6 };
+    GfxStressRange trianglesPerStateChange = { 8, 64 };
+    // Vertices per G_VTX, clamped to [3, 32]
+    GfxStressRange verticesPerLoad = { 8, 32 };
+    std::vector<GfxStressTextureFormat> textureFormats = {
+        { G_IM_FMT_RGBA, G_IM_SIZ_16b }, { G_IM_FMT_CI, G_IM_SIZ_4b }, { G_IM_FMT_CI, G_IM_SIZ_8b },
+        { G_IM_FMT_IA, G_IM_SIZ_8b },    { G_IM_FMT_I, G_IM_SIZ_8b },
+    };
+    // Texture edge length in texels, rounded down to a power of two and shrunk until the texture fits TMEM
+    GfxStressRange textureSize = { 16, 64 };
+    uint32_t textureCount = 32;
+    uint32_t combinerCount = 8;
+    // Chance a state change also draws a G_TEXRECT with the texture it loaded
+    float texRectDensity = 0.05f;
+    // Full screen S2DEX backgrounds drawn per frame, alternating between G_BG_1CYC and G_BG_COPY
+    uint32_t backgroundCount = 0;
+};
+
+// What a generated workload contains. Counts are per execution of the root display list.
+struct GfxStressStats {
+    size_t commands = 0;
+    size_t displayLists = 0;
+    size_t vertices = 0;
+    size_t triangles = 0;
+    size_t texRects = 0;
+    size_t stateChanges = 0;
+    size_t backgrounds = 0;
+    size_t segmentBytes = 0;
+    uint32_t maxDepth = 0;
+};
+
+// A generated display list together with the synthetic memory it references. The root list sets up its own
+// segments, so it can be handed to Interpreter::Run as-is for as long as the workload is alive.
+class GfxStressWorkload {
+  public:
+    static constexpr uint32_t VERTEX_SEGMENT = 1;
+    static constexpr uint32_t TEXTURE_SEGMENT = 2;
+    static constexpr uint32_t DATA_SEGMENT = 3;
+    static constexpr uint32_t DISPLAY_LIST_SEGMENT = 4;
+
+    F3DGfx* GetRootDisplayList();
+    const std::vector<F3DGfx>& GetRootCommands() const;
+    const std::vector<F3DGfx>& GetDisplayListArena() const;
+    const GfxStressStats& GetStats() const;
+
+  private:
+    friend class GfxStressGenerator;
+
+    std::vector<F3DGfx> mRoot;
+    std::vector<F3DGfx> mDisplayLists;
+    std::vector<uint64_t> mVertices;
+    std::vector<uint64_t> mTextures;
+    std::vector<uint64_t> mData;
+    GfxStressStats mStats;
+};
+
+// Builds random but valid F3DEX2/S2DEX command streams for benchmarking the interpreter without game data. The
+// same config always produces the same workload, independent of platform.
+class GfxStressGenerator {
+  public:
+    explicit GfxStressGenerator(const GfxStressConfig& config);
+
+    // Returns nullptr if the workload does not fit the 16 MB a segment can address
+    std::unique_ptr<GfxStressWorkload> Generate();
+
+  private:
+    struct Texture {
+        uint8_t fmt;
+        uint8_t siz;
+        uint32_t width;
+        uint32_t height;
+        uint32_t offset;
+        uint32_t paletteOffset;
+        uint32_t paletteCount;
+    };
+
+    struct Combiner {
+        uint32_t w0;
+        uint32_t w1;
+    };
+
+    uint32_t Next(GfxStressRange range);
+    bool Chance(float probability);
+    uint32_t Allocate(std::vector<uint64_t>& arena, size_t size);
+    uint8_t* Data(std::vector<uint64_t>& arena, uint32_t offset);
+    void WriteMatrix(uint32_t offset, const float matrix[4][4]);
+
+    void GenerateTextures();
+    void GenerateCombiners();
+    uint32_t GenerateDisplayList(uint32_t depth);
+    void EmitTextureLoad(std::vector<F3DGfx>& list, const Texture& tex);
+    void EmitTriangles(std::vector<F3DGfx>& list, uint32_t count);
+    void EmitTexRect(std::vector<F3DGfx>& list, const Texture& tex);
+    void EmitRoot(const std::vector<uint32_t>& objects, const std::vector<uint32_t>& backgrounds);
+
+    void Emit(std::vector<F3DGfx>& list, uintptr_t w0, uintptr_t w1);
+
+    GfxStressConfig mConfig;
+    std::mt19937 mRng;
+    std::unique_ptr<GfxStressWorkload> mWorkload;
+    std::vector<Texture> mTexturePool;
+    std::vector<Combiner> mCombinerPool;
+};
+
+} // namespace Fast
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Fast {
+
+// A single executed display list command. Plain data so the ring buffer can be written to disk as-is.
+struct GfxTraceEntry {
+    uint64_t timestamp; // steady clock, in nanoseconds
+    uint64_t w0;
+    uint64_t w1;
+    uint16_t depth; // display list call depth when the command ran
+    int8_t opcode;
+    uint8_t ucode; // UcodeHandlers that was loaded when the command ran
+    uint32_t reserved;
+};
+
+static_assert(sizeof(GfxTraceEntry) == 32, "GfxTraceEntry is part of the trace file format");
+
+// Binary trace of the commands executed by the interpreter. Recording only stores a fixed size entry in a
+// preallocated ring buffer, so it can stay armed in release builds; the oldest entries are overwritten once the
+// buffer is full. Producers never take a lock: several interpreters may record into the same trace concurrently.
+// Each slot carries a sequence number, so readers skip slots that are being written instead of copying torn entries.
+class GfxTraceRecorder {
+  public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    // Capacity is rounded up to a power of two
+    explicit GfxTraceRecorder(size_t capacity = DEFAULT_CAPACITY);
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    void Record(int8_t opcode, uint8_t ucode, uintptr_t w0, uintptr_t w1, size_t depth);
+    void Clear();
+
+    size_t GetCapacity() const;
+    uint64_t GetRecordedCount() const;
+
+    // Copies the retained entries, oldest first. Entries that are being written or overwritten while the snapshot is
+    // taken are left out, so disable the recorder first when a gapless capture is needed.
+    std::vector<GfxTraceEntry> Snapshot() const;
+
+    // Writes the retained entries to a binary trace file that can be read back with Load.
+    bool Dump(const std::string& path) const;
+    static bool Load(const std::string& path, std::vector<GfxTraceEntry>& entries);
+    // Human readable form of an entry, with the opcode name resolved through GfxGetOpcodeName.
+    static std::string FormatEntry(const GfxTraceEntry& entry);
+
+  private:
+    // Entry n of the trace lives in slot n & mMask. Its sequence is 2n + 1 while entry n is written and 2n + 2 once
+    // it is complete. The fields are atomics too, a reader may load them while a producer stores.
+    struct Slot {
+        std::atomic<uint64_t> Sequence = 0;
+        std::atomic<uint64_t> Timestamp = 0;
+        std::atomic<uint64_t> W0 = 0;
+        std::atomic<uint64_t> W1 = 0;
+        // depth | opcode << 16 | ucode << 24
+        std::atomic<uint32_t> Info = 0;
+    };
+
+    std::unique_ptr<Slot[]> mSlots;
+    size_t mMask;
+    std::atomic<uint64_t> mHead = 0;
+    // First entry that is not cleared. Entry numbers keep growing across Clear, so sequences stay unique per slot.
+    std::atomic<uint64_t> mStart = 0;
+    std::atomic<bool> mEnabled = false;
+};
+
+} // namespace Fast
@@ -10,6 +10,7 @@
 #include <stack>
 #include <string>
 #include <string_view>
+#include <span>
 #include <memory>
 
 #include "fast/lus_gbi.h"
@@ -17,6 +18,7 @@
 #include "fast/ucodehandlers.h"
 #include "backends/gfx_rendering_api.h"
 #include "fast/debug/GfxDebugger.h"
+#include "fast/debug/GfxTraceRecorder.h"
 
 #include "fast/resource/type/Texture.h"
 #include "ship/resource/Resource.h"
@@ -140,15 +142,22 @@ constexpr int16_t ShaderIdUnmask(int id) {
     return (id >> SHADER_ID_SHIFT) & 0xFFFF;
 }
 
+// N64 microcodes limit display list call nesting to 18 levels (F3DEX2), the remaining room is used by the branch markers
+// that are only pushed while the debugger records call paths.
+#define GFX_EXEC_STACK_MAX_DEPTH 64
+
 struct GfxExecStack {
     // This is a dlist stack used to handle dlist calls.
-    std::stack<F3DGfx*> cmd_stack = {};
-    // This is also a dlist stack but a std::vector is used to make it possible
-    // to iterate on the elements.
+    F3DGfx* cmd_stack[GFX_EXEC_STACK_MAX_DEPTH] = {};
+    size_t cmd_stack_size = 0;
     // The purpose of this is to identify an instruction at a poin in time
     // which would not be possible with just a F3DGfx* because a dlist can be called multiple times
-    // what we do instead is store the call path that leads to the instruction (including branches)
-    std::vector<const F3DGfx*> gfx_path = {};
+    // what we do instead is store the call path that leads to the instruction (including branches).
+    // It is only recorded while debugging, with one caller per stack entry and one spare slot for the current
+    // instruction.
+    const F3DGfx* gfx_path[GFX_EXEC_STACK_MAX_DEPTH + 1] = {};
+    size_t gfx_path_size = 0;
+    bool record_path = false;
     struct CodeDisp {
         const char* file;
         int line;
@@ -156,14 +165,18 @@ struct GfxExecStack {
     // stack for OpenDisp/CloseDisps
     std::vector<CodeDisp> disp_stack{};
 
-    void start(F3DGfx* dlist);
+    void start(F3DGfx* dlist, bool recordPath);
     void stop();
+    bool empty() const;
+    size_t depth() const;
     F3DGfx*& currCmd();
+    // Call path to the current instruction, only valid while recording paths
+    std::span<const F3DGfx* const> currPath();
     void openDisp(const char* file, int line);
     void closeDisp();
     const std::vector<CodeDisp>& getDisp() const;
     void branch(F3DGfx* caller);
-    void call(F3DGfx* caller, F3DGfx* callee);
+    bool call(F3DGfx* caller, F3DGfx* callee);
     F3DGfx* ret();
 };
 
@@ -202,6 +215,8 @@ struct TextureCacheValue {
     uint32_t texture_id;
     uint8_t cms, cmt;
     bool linear_filter;
+    // Keeps the texture resource out of eviction while its address keys this entry
+    std::shared_ptr<Fast::Texture> resource;
 
     std::list<struct TextureCacheMapIter>::iterator lru_location;
 };
@@ -228,6 +243,16 @@ struct RawTexMetadata {
     Fast::TextureType type;
 };
 
+// Where an S2DEX background image resolved to. Cached per image pointer, so a background drawn every frame skips the
+// resource lookup. The pointer may be a buffer the game reuses, so hits are checked against the path it holds.
+struct S2dexBgImage {
+    uintptr_t data;
+    uint32_t texFlags;
+    RawTexMetadata rawTexMetadata;
+    std::string path; // resource path the pointer held, empty for raw image data
+    bool altAssets;   // resolved while alt assets were enabled
+};
+
 #define MAX_LIGHTS 32
 #define MAX_VERTICES 64
 
@@ -331,8 +356,6 @@ typedef enum Attribute {
     MV_LIGHT,
 } Attribute;
 
-extern GfxExecStack g_exec_stack;
-
 struct GfxTextureCache {
     TextureCacheMap map;
     std::list<TextureCacheMapIter> lru;
@@ -368,8 +391,29 @@ struct MaskedTextureEntry {
     uint8_t* replacementData;
 };
 
-class Interpreter {
+// Masked texture registered for the path of a texture resource, resolved once per resource so texture loads skip the
+// path lookup
+struct MaskedTextureLookup {
+    std::weak_ptr<Fast::Texture> resource;
+    const MaskedTextureEntry* entry;
+};
+
+class Interpreter : public std::enable_shared_from_this<Interpreter> {
   public:
+    // Makes an interpreter the one that the free gfx_* entry points act on for the calling thread, until the scope
+    // ends. Threads without one use the interpreter of the window. Run binds its interpreter for the frame, a thread
+    // driving another interpreter, e.g. for headless rendering, binds it for as long as it uses it.
+    class ThreadScope {
+      public:
+        explicit ThreadScope(Interpreter* gfx);
+        ~ThreadScope();
+        ThreadScope(const ThreadScope&) = delete;
+        ThreadScope& operator=(const ThreadScope&) = delete;
+
+      private:
+        Interpreter* mPrevious;
+    };
+
     Interpreter();
     ~Interpreter();
 
@@ -378,6 +422,8 @@ class Interpreter {
     void Destroy();
     void SetGfxDebugger(std::shared_ptr<GfxDebugger> debugger);
     std::shared_ptr<GfxDebugger> GetGfxDebugger() const;
+    void SetGfxTraceRecorder(std::shared_ptr<GfxTraceRecorder> recorder);
+    std::shared_ptr<GfxTraceRecorder> GetGfxTraceRecorder() const;
     void GetDimensions(uint32_t* width, uint32_t* height, int32_t* posX, int32_t* posY);
     GfxRenderingAPI* GetCurrentRenderingAPI();
     void StartFrame();
@@ -398,6 +444,12 @@ class Interpreter {
     void AdjustPixelDepthCoordinates(float& x, float& y);
     void GetPixelDepthPrepare(float x, float y);
     uint16_t GetPixelDepth(float x, float y);
+    // Asynchronous variants of GetPixelDepth. The coordinates are queued for a readback that the next Run issues
+    // without stalling, right after its display list has executed. The readback is collected by the first query after
+    // that Run, so a coordinate returns the depth drawn by the last frame if it was also queried before that frame,
+    // and 0 otherwise.
+    uint16_t GetPixelDepthAsync(float x, float y);
+    void GetPixelDepthBatchAsync(const float* xs, const float* ys, uint16_t* depths, size_t count);
     void RegisterBlendedTexture(const char* name, uint8_t* mask, uint8_t* replacement);
     void UnregisterBlendedTexture(const char* name);
 
@@ -411,6 +463,9 @@ class Interpreter {
     void SetResolutionMultiplier(float multiplier);
     void SetMsaaLevel(uint32_t level);
     void GetCurDimensions(uint32_t* width, uint32_t* height);
+    void SetTextureFilter(FilteringMode mode);
+    void SetTargetUcode(UcodeHandlers ucode);
+    void PushCurrentDir(char* path);
 
     // private: TODO make these private
     void Flush();
@@ -418,7 +473,7 @@ class Interpreter {
     ColorCombiner* LookupOrCreateColorCombiner(const ColorCombinerKey& key);
     void ShaderCacheClear();
     void TextureCacheClear();
-    bool TextureCacheLookup(int i, const TextureCacheKey& key);
+    bool TextureCacheLookup(int i, const TextureCacheKey& key, std::shared_ptr<Fast::Texture> resource);
     void TextureCacheDelete(const uint8_t* origAddr);
     void ImportTextureRgba16(int tile, bool importReplacement);
     void ImportTextureRgba32(int tile, bool importReplacement);
@@ -433,6 +488,7 @@ class Interpreter {
     void ImportTextureImg(int tile, bool importReplacement);
     void ImportTexture(int i, int tile, bool importReplacement);
     void ImportTextureMask(int i, int tile);
+    const MaskedTextureEntry* FindMaskedTexture(const std::shared_ptr<Fast::Texture>& resource);
     void CalculateNormalDir(const F3DLight_t*, float coeffs[3]);
 
     void GfxSpMatrix(uint8_t params, const int32_t* addr);
@@ -474,6 +530,7 @@ class Interpreter {
     void GfxSpSetOtherMode(uint32_t shift, uint32_t num_bits, uint64_t mode);
     void GfxDpSetOtherMode(uint32_t h, uint32_t l);
 
+    const S2dexBgImage* S2dexBgImageLookup(const F3DuObjBg* bg);
     void Gfxs2dexBgCopy(F3DuObjBg* bg);
     void Gfxs2dexBg1cyc(F3DuObjBg* bg);
     void Gfxs2dexRecyCopy(F3DuObjSprite* spr);
@@ -486,6 +543,9 @@ class Interpreter {
 
     void SpReset();
     void* SegAddr(uintptr_t w1);
+    uint32_t GetAttr(Attribute attr) const;
+    void LoadUcode(UcodeHandlers ucode);
+    void Step();
 
     static const char* CCMUXtoStr(uint32_t ccmux);
     static const char* ACMUXtoStr(uint32_t acmux);
@@ -500,6 +560,7 @@ class Interpreter {
     RenderingState mRenderingState{};
 
     GfxTextureCache mTextureCache{};
+    std::unordered_map<const void*, S2dexBgImage> mS2dexBgImages;
     std::map<ColorCombinerKey, ColorCombiner> mColorCombinerPool; // color_combiner_pool;
     std::map<ColorCombinerKey, ColorCombiner>::iterator mPrevCombiner = mColorCombinerPool.end();
     uint8_t* mTexUploadBuffer = nullptr;
@@ -522,6 +583,7 @@ class Interpreter {
     GfxWindowBackend* mWapi = nullptr;
     GfxRenderingAPI* mRapi = nullptr;
     std::shared_ptr<GfxDebugger> mGfxDebugger;
+    std::shared_ptr<GfxTraceRecorder> mGfxTraceRecorder;
 
     uintptr_t mSegmentPointers[MAX_SEGMENT_POINTERS]{};
 
@@ -535,7 +597,11 @@ class Interpreter {
 
     std::set<std::pair<float, float>> mGetPixelDepthPending; // get_pixel_depth_pending;
     std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> mGetPixelDepthCached; // get_pixel_depth_cached;
+    std::set<std::pair<float, float>> mGetPixelDepthAsyncPending;
+    std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> mGetPixelDepthAsyncCached;
+    bool mGetPixelDepthAsyncInFlight = false;
     std::map<std::string, MaskedTextureEntry, std::less<>> mMaskedTextures;
+    std::unordered_map<const Fast::Texture*, MaskedTextureLookup> mMaskedTextureLookups;
     std::unordered_map<uintptr_t, int> mFbTextures; // CPU addr -> GPU FB id
 
     const std::unordered_map<Mtx*, MtxF>* mCurMtxReplacements;
@@ -547,6 +613,10 @@ class Interpreter {
     size_t mShadersIndex;
     int mInterpolationIndex;
     int mInterpolationIndexTarget;
+
+    GfxExecStack mExecStack{};
+    UcodeHandlers mUcodeHandlerIndex = ucode_f3dex2;
+    std::stack<std::string> mCurrentDir;
 };
 
 void gfx_set_target_ucode(UcodeHandlers ucode);
@@ -554,6 +624,7 @@ void gfx_push_current_dir(char* path);
 int32_t gfx_check_image_signature(const char* imgData);
 const char* gfx_get_shader(int16_t id);
 const char* GfxGetOpcodeName(int8_t opcode);
+const char* GfxGetOpcodeName(int8_t opcode, UcodeHandlers ucode);
 
 } // namespace Fast
 
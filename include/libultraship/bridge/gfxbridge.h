@@ -37,6 +37,31 @@ API_EXPORT void GfxGetPixelDepthPrepare(float x, float y);
  */
 API_EXPORT uint16_t GfxGetPixelDepth(float x, float y);
 
+/**
+ * @brief Returns the pixel depth at screen coordinate (@p x, @p y) without stalling the GPU.
+ *
+ * The coordinate is queued for a readback issued at the end of the current frame, and the value returned is the one
+ * read back for the same coordinate on the previous frame. Results therefore lag one frame behind, and a coordinate
+ * that was not requested on the previous frame (including the very first request) returns 0.
+ *
+ * @param x Screen X coordinate in pixels.
+ * @param y Screen Y coordinate in pixels.
+ * @return Depth value from the previous frame in the range [0, 65535], or 0 if none is available yet.
+ */
+API_EXPORT uint16_t GfxGetPixelDepthAsync(float x, float y);
+
+/**
+ * @brief Batched form of GfxGetPixelDepthAsync() for querying many coordinates at once.
+ *
+ * All coordinates are read back together with a single readback, with the same one-frame latency.
+ *
+ * @param xs     Screen X coordinates in pixels.
+ * @param ys     Screen Y coordinates in pixels.
+ * @param depths Receives the previous frame's depth value (or 0) for each coordinate.
+ * @param count  Number of coordinates.
+ */
+API_EXPORT void GfxGetPixelDepthBatchAsync(const float* xs, const float* ys, uint16_t* depths, uint32_t count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,6 +35,36 @@ API_EXPORT bool GfxDebuggerIsDebuggingRequested();
  */
 API_EXPORT void GfxDebuggerDebugDisplayList(void* cmds);
 
+/**
+ * @brief Arms or disarms the binary GBI trace recorder.
+ *
+ * While armed, every executed display list command is appended to a fixed-size ring buffer
+ * (opcode, w0, w1, call depth and timestamp). The oldest commands are overwritten once it is full.
+ *
+ * @param enabled true to start recording, false to stop.
+ */
+API_EXPORT void GfxTraceSetEnabled(bool enabled);
+
+/**
+ * @brief Returns true while the binary GBI trace recorder is armed.
+ */
+API_EXPORT bool GfxTraceIsEnabled();
+
+/**
+ * @brief Discards all commands currently held by the GBI trace recorder.
+ */
+API_EXPORT void GfxTraceClear();
+
+/**
+ * @brief Writes the commands currently held by the GBI trace recorder to a binary trace file.
+ *
+ * The file can be decoded offline with Fast::GfxTraceRecorder::Load and FormatEntry.
+ *
+ * @param path Destination file path.
+ * @return true if the file was written successfully.
+ */
+API_EXPORT bool GfxTraceDump(const char* path);
+
 #ifdef __cplusplus
 };
 #endif
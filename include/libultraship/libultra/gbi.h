@@ -2806,6 +2806,18 @@ typedef union Gfx {
         _g1->words.w1 = _SHIFTL(height, 16, 16) | _SHIFTL(width, 0, 16);                      \
     }
 
+// Same as gDPReadFB but without stalling on the GPU: the buffer receives the pixels requested by the previous
+// gDPReadFBAsync for the same framebuffer and size (one frame of latency) and is left untouched on the first call
+#define gDPReadFBAsync(pkt, src, rgba16buf, ulx, uly, width, height, bswap)                                      \
+    {                                                                                                            \
+        Gfx *_g0 = (Gfx*)(pkt), *_g1 = (Gfx*)(pkt);                                                              \
+                                                                                                                 \
+        _g0->words.w0 = _SHIFTL(G_READFB, 24, 8) | _SHIFTL(1, 9, 1) | _SHIFTL(bswap, 8, 1) | _SHIFTL(src, 0, 8); \
+        _g0->words.w1 = (uintptr_t)rgba16buf;                                                                    \
+        _g1->words.w0 = _SHIFTL(uly, 16, 16) | _SHIFTL(ulx, 0, 16);                                              \
+        _g1->words.w1 = _SHIFTL(height, 16, 16) | _SHIFTL(width, 0, 16);                                         \
+    }
+
 #define gDPImageRectangle(pkt, x0, y0, s0, t0, x1, y1, s1, t1, tile, iw, ih) \
     {                                                                        \
         Gfx *_g0 = (Gfx*)(pkt), *_g1 = (Gfx*)(pkt), *_g2 = (Gfx*)(pkt);      \
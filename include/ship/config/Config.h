@@ -2,6 +2,15 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
 #include <nlohmann/json.hpp>
 
 #include "ship/window/Window.h"
@@ -163,12 +172,34 @@ class Config {
      */
     bool Contains(const std::string& key);
 
-    /** @brief Discards in-memory values and reloads the config file from disk. */
+    /**
+     * @brief Discards in-memory values and reloads the config file from disk.
+     *
+     * Pending saves are written first, so the file read back is never older than the in-memory values.
+     */
     void Reload();
 
-    /** @brief Flushes in-memory values to the config file on disk. */
+    /**
+     * @brief Schedules the in-memory values to be written to the config file on disk.
+     *
+     * A snapshot of the values is taken immediately and written by a background thread once no further save has
+     * been requested for the save delay, so bursts of saves (e.g. while dragging a slider) produce a single write.
+     * The file is written to a temporary file next to it and renamed over it, so a crash mid-write never leaves a
+     * truncated config behind. Use Flush() to wait for the write.
+     */
     void Save();
 
+    /** @brief Blocks until every scheduled save has been written to disk. */
+    void Flush();
+
+    /**
+     * @brief Sets how long Save() waits for further save requests before writing.
+     *
+     * Requests keep postponing the write up to four times this delay. A delay of zero writes on every request.
+     * @param delay Time to coalesce save requests for.
+     */
+    void SetSaveDelay(std::chrono::milliseconds delay);
+
     /**
      * @brief Returns the full config as a nested JSON object.
      *
@@ -226,10 +257,53 @@ class Config {
     template <typename T> std::vector<T> GetArray(const std::string& key);
 
   private:
+    // Flattened values of the blocks that changed since the last save, keyed by block. A block is the subtree below
+    // a second level key (e.g. "/CVars/gSettings"), or a leaf above that. Removed blocks have no value.
+    struct SaveRequest {
+        bool Reset = false;
+        std::map<std::string, std::optional<nlohmann::json>> Blocks;
+    };
+
+    // Serialized text of one top-level key: either a leaf value or the serialized blocks below it
+    struct SerializedNode {
+        std::optional<std::string> Value;
+        std::map<std::string, std::string> Children;
+    };
+
+    static std::string GetBlockKey(const std::string& flattenedKey);
+    void MarkDirty(const std::string& flattenedKey);
+    void MarkAllDirty();
+    std::optional<nlohmann::json> CollectBlock(const std::string& block);
+    void SaveThread();
+    void Write(const SaveRequest& request);
+    std::string Serialize(const SaveRequest& request);
+
     nlohmann::json mFlattenedJson;
     nlohmann::json mNestedJson;
+    // mNestedJson no longer matches what was last loaded or saved
+    bool mNestedJsonStale = false;
     std::string mPath;
     bool mIsNewInstance;
     std::map<uint32_t, std::shared_ptr<ConfigVersionUpdater>> mVersionUpdaters;
+
+    // Background writer, started by the first Save()
+    std::thread mSaveThread;
+    std::mutex mSaveMutex;
+    std::condition_variable mSaveRequested;
+    std::condition_variable mSaveFinished;
+    // Blocks changed since the last Save()
+    std::set<std::string> mDirtyBlocks;
+    bool mAllDirty = true;
+    std::unique_ptr<SaveRequest> mPendingSave;
+    // Only used by the writer thread
+    std::map<std::string, SerializedNode> mSerializedTree;
+    // Set by the writer thread when mSerializedTree had to be dropped
+    std::atomic<bool> mSaveResync = false;
+    std::chrono::steady_clock::time_point mFirstSaveRequest;
+    std::chrono::steady_clock::time_point mLastSaveRequest;
+    std::chrono::milliseconds mSaveDelay = std::chrono::milliseconds(250);
+    bool mSaveWriting = false;
+    bool mSaveFlushing = false;
+    bool mSaveStopping = false;
 };
 } // namespace Ship
@@ -3,12 +3,18 @@
 #include "ship/utils/color.h"
 #include <nlohmann/json.hpp>
 #include <stdint.h>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <shared_mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace Ship {
+class Config;
 
 /** @brief Discriminator tag for the active field of the CVar union. */
 typedef enum class ConsoleVariableType { Integer, Float, String, Color, Color24 } ConsoleVariableType;
@@ -39,6 +45,14 @@ typedef struct CVar {
     }
 } CVar;
 
+/**
+ * @brief Callback fired after a CVar changed.
+ * @param name     CVar name.
+ * @param variable Copy of the CVar after the change, valid until the callback returns, or nullptr when it was
+ *                 cleared.
+ */
+typedef std::function<void(const char* name, const CVar* variable)> CVarChangedCallback;
+
 /**
  * @brief Manages a named collection of console variables (CVars).
  *
@@ -46,15 +60,25 @@ typedef struct CVar {
  * from a JSON file via the Config layer. Values can be registered with defaults,
  * queried, mutated, copied, and cleared at runtime.
  *
+ * All members may be called from any thread.
+ *
  * Obtain the singleton instance from Context::GetConsoleVariables().
  */
 class ConsoleVariable {
   public:
     ConsoleVariable();
+    /**
+     * @brief Creates console variables backed by the given config instead of the Context's.
+     * @param config Config the CVars are loaded from and saved to.
+     */
+    explicit ConsoleVariable(std::shared_ptr<Config> config);
     ~ConsoleVariable();
 
     /**
      * @brief Returns the raw CVar entry for the given name, or nullptr if not found.
+     *
+     * The entry is changed in place without synchronisation with its readers, prefer the typed getters for CVars
+     * other threads may set.
      * @param name CVar name (case-sensitive).
      */
     std::shared_ptr<CVar> Get(const char* name);
@@ -77,7 +101,7 @@ class ConsoleVariable {
      * @brief Returns the string value of a CVar, or the default if not found or wrong type.
      * @param name         CVar name.
      * @param defaultValue Value to return when the CVar is absent.
-     * @return Pointer to internal storage; do not free or store long-term.
+     * @return Pointer to internal storage, valid until the CVar next changes; do not free or store long-term.
      */
     const char* GetString(const char* name, const char* defaultValue);
 
@@ -184,18 +208,53 @@ class ConsoleVariable {
      */
     void CopyVariable(const char* from, const char* to);
 
-    /** @brief Serializes all CVars to the backing JSON config file. */
+    /** @brief Writes the CVars changed since the last save or load to the backing JSON config file. */
     void Save();
 
     /** @brief Loads CVars from the backing JSON config file, overwriting in-memory values. */
     void Load();
 
+    /**
+     * @brief Returns a counter that changes whenever CVars are added or removed.
+     *
+     * Values changed in place do not advance it. A cached CVar entry stays valid for as long as the generation
+     * it was looked up in is current.
+     */
+    uint64_t GetGeneration() const;
+
+    /**
+     * @brief Registers a callback fired whenever the named CVar changes value or type, or is cleared.
+     *
+     * Setting a CVar to the value it already holds does not fire. Callbacks run synchronously on the thread that
+     * changed the CVar, and fire for every CVar again when the config is reloaded, with nullptr for the CVars the
+     * reload removed.
+     * @param name     CVar name; the CVar does not need to exist yet.
+     * @param callback Function to invoke.
+     * @return ID to pass to UnregisterChangeCallback().
+     */
+    uint32_t RegisterChangeCallback(const char* name, CVarChangedCallback callback);
+
+    /**
+     * @brief Removes a callback registered with RegisterChangeCallback().
+     * @param id ID returned at registration.
+     */
+    void UnregisterChangeCallback(uint32_t id);
+
+    /**
+     * @brief Returns a number that advances on every CVar change.
+     *
+     * Lets code that caches derived state check cheaply whether any setting changed since it last looked.
+     */
+    uint64_t GetChangeSequence() const;
+
   protected:
     void LoadFromPath(std::string path,
                       nlohmann::detail::iteration_proxy<nlohmann::detail::iter_impl<nlohmann::json>> items);
     void LoadLegacy();
 
   private:
+    template <typename T> friend class CVarHandle;
+
     struct TransparentStringHash {
         using is_transparent = void;
         size_t operator()(std::string_view sv) const noexcept {
@@ -208,6 +267,66 @@ class ConsoleVariable {
             return a == b;
         }
     };
+    struct ChangeCallback {
+        uint32_t Id;
+        // Shared so a callback unregistered while the list is being fired stays alive until it returns
+        std::shared_ptr<CVarChangedCallback> Callback;
+    };
+
+    template <typename T> T GetValue(const char* name, T defaultValue);
+    // Applies assign to the named CVar and fires its callbacks when it reports a change
+    template <typename Assign> void Update(const char* name, bool onlyIfAbsent, Assign assign);
+    std::shared_ptr<CVar>& Emplace(const char* name, bool& created);
+    void MarkChanged(const char* name);
+    std::vector<ChangeCallback> GetChangeCallbacks(const char* name) const;
+    // Must be called without holding mMutex
+    static void FireChangeCallbacks(const char* name, const std::vector<ChangeCallback>& callbacks,
+                                    const CVar* variable);
+
+    std::shared_ptr<Config> mConfig;
+    // Guards the maps below and the CVar values, callbacks are fired after releasing it
+    mutable std::shared_mutex mMutex;
+
     std::unordered_map<std::string, std::shared_ptr<CVar>, TransparentStringHash, TransparentStringEqual> mVariables;
+    std::atomic<uint64_t> mGeneration = 1;
+    std::unordered_map<std::string, std::vector<ChangeCallback>, TransparentStringHash, TransparentStringEqual>
+        mChangeCallbacks;
+    uint32_t mNextChangeCallbackId = 0;
+    std::atomic<uint64_t> mChangeSequence = 0;
+    // Changed since the values in the config, cleared ones are already erased there
+    std::unordered_set<std::string> mDirtyVariables;
+};
+
+/**
+ * @brief Typed, cached reference to a CVar for code that reads it every frame or draw call.
+ *
+ * The value is cached in the handle and looked up again only after some CVar changed, so steady-state reads take no
+ * lock and skip hashing the name. Conversions match the ConsoleVariable getters. A handle may be read from several
+ * threads at once.
+ *
+ * @tparam T One of int32_t, float, std::string, Color_RGBA8 or Color_RGB8. String handles return a copy and take the
+ * CVar lock on every read, they are not meant for per-draw code.
+ */
+template <typename T> class CVarHandle {
+  public:
+    /**
+     * @param name         CVar name.
+     * @param defaultValue Value to return while the CVar is absent or of another type.
+     */
+    CVarHandle(const char* name, T defaultValue);
+
+    /** @brief Returns the current value of the CVar. */
+    T Get();
+
+  private:
+    static constexpr uint64_t sNoSequence = UINT64_MAX;
+
+    std::string mName;
+    T mDefaultValue;
+    // Resolved from the Context on first use, the handles only run while it is alive
+    std::atomic<ConsoleVariable*> mConsoleVariables = nullptr;
+    // Bits of the cached value for the change sequence in mSequence, published by its release store
+    std::atomic<uint32_t> mValue = 0;
+    std::atomic<uint64_t> mSequence = sNoSequence;
 };
 } // namespace Ship
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include "ship/resource/File.h"
 
 namespace Ship {
@@ -58,8 +59,12 @@ class IResource {
     std::shared_ptr<ResourceInitData> GetInitData();
 
   private:
+    friend class ResourceManager;
+
     std::shared_ptr<ResourceInitData> mInitData;
     bool mIsDirty = false;
+    // Set once the ResourceManager handed out GetRawPointer(), which keeps the resource from being evicted
+    std::atomic<bool> mRawPointerShared = false;
 };
 
 /**
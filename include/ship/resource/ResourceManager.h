@@ -1,12 +1,17 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <future>
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
 #include <list>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
 #include <queue>
+#include <thread>
 #include <variant>
 #include "ship/resource/Resource.h"
 #include "ship/resource/ResourceLoader.h"
@@ -75,6 +80,67 @@ struct ResourceIdentifierHash {
     size_t operator()(const ResourceIdentifier& rcd) const;
 };
 
+/**
+ * @brief Progress and results of a bulk load started by ResourceManager::LoadResourcesBatch().
+ *
+ * The matched files are loaded across the resource thread pool. Every file has its own future,
+ * and GetFuture() completes once all of them are done.
+ */
+class ResourceLoadBatch {
+    friend class ResourceManager;
+
+  public:
+    /** @brief Returns the paths being loaded, in the order of the loaded resources. */
+    const std::vector<std::string>& GetFiles() const;
+
+    /** @brief Returns the number of files in the batch. */
+    size_t GetFileCount() const;
+
+    /** @brief Returns how many files have finished loading, whether they succeeded or not. */
+    size_t GetLoadedCount() const;
+
+    /** @brief Returns the fraction of files that have finished loading, 1 for an empty batch. */
+    float GetProgress() const;
+
+    /** @brief Returns true once every file has finished loading. */
+    bool IsDone() const;
+
+    /**
+     * @brief Returns the future of a single file.
+     * @param index Index of the file in GetFiles().
+     * @return Shared future resolving to the loaded IResource (or nullptr on failure).
+     */
+    std::shared_future<std::shared_ptr<IResource>> GetResource(size_t index) const;
+
+    /**
+     * @brief Returns a future for the whole batch.
+     * @return Shared future resolving to the loaded IResource objects, in GetFiles() order.
+     */
+    std::shared_future<std::shared_ptr<std::vector<std::shared_ptr<IResource>>>> GetFuture() const;
+
+    /** @brief Blocks until every file has finished loading. */
+    void Wait() const;
+
+  private:
+    explicit ResourceLoadBatch(std::vector<std::string>&& files);
+
+    // Records the result of the file at index, completing the batch after the last one
+    void Finish(size_t index, std::shared_ptr<IResource> resource, std::exception_ptr error);
+
+    const std::vector<std::string> mFiles;
+    std::vector<std::promise<std::shared_ptr<IResource>>> mPromises;
+    std::vector<std::shared_future<std::shared_ptr<IResource>>> mFutures;
+    // Each slot is only written by the task loading that file
+    std::shared_ptr<std::vector<std::shared_ptr<IResource>>> mResources;
+    std::promise<std::shared_ptr<std::vector<std::shared_ptr<IResource>>>> mDone;
+    std::shared_future<std::shared_ptr<std::vector<std::shared_ptr<IResource>>>> mDoneFuture;
+    // Next file to hand out to a loading task
+    std::atomic<size_t> mNext = 0;
+    std::atomic<size_t> mLoaded = 0;
+    std::mutex mErrorMutex;
+    std::exception_ptr mError;
+};
+
 /**
  * @brief Central manager for loading, caching, and unloading game resources.
  *
@@ -82,6 +148,15 @@ struct ResourceIdentifierHash {
  * an in-memory cache of loaded IResource objects, dispatches asynchronous load requests
  * to a thread pool, and delegates actual deserialization to ResourceLoader.
  *
+ * The cache is split into shards by identifier hash, each behind its own reader/writer
+ * lock, so cache hits from different threads don't serialize.
+ *
+ * The cache can be given a memory budget, measured with IResource::GetPointerSize().
+ * When it is exceeded, the least recently used resources that nothing outside the cache
+ * references and that are not pinned are evicted.
+ *
+ * Concurrent requests for a resource that is not cached yet share a single load.
+ *
  * Typical usage:
  * @code
  * auto rm = Ship::Context::GetInstance()->GetResourceManager();
@@ -144,6 +219,10 @@ class ResourceManager {
 
     /**
      * @brief Loads a resource synchronously by ResourceIdentifier.
+     *
+     * On a thread of the resource thread pool the resource is loaded on the calling thread
+     * rather than queued, so resource factories can load their dependencies.
+     *
      * @param identifier Exact identifier (path + owner + parent archive).
      * @param loadExact  If true, skips alt-asset path resolution.
      * @param initData   Optional metadata overrides.
@@ -223,6 +302,55 @@ class ResourceManager {
      */
     size_t UnloadResource(const std::string& filePath);
 
+    /**
+     * @brief Sets the memory budget of the resource cache and evicts resources until it is met.
+     *
+     * Only resources that are not pinned and not referenced outside the cache can be evicted,
+     * so the cache may stay above the budget. Resources whose payload was returned by
+     * GetResourceRawPointer() are never evicted, nothing tracks how long that pointer is used.
+     * When nothing more can be evicted, the next attempt waits until the cache has grown by
+     * 1/16 of the budget or a pin is released.
+     *
+     * @param bytes Budget in bytes, 0 for no limit (the default).
+     */
+    void SetMemoryBudget(size_t bytes);
+
+    /** @brief Returns the memory budget of the resource cache in bytes, 0 if there is no limit. */
+    size_t GetMemoryBudget();
+
+    /** @brief Returns the combined size of all cached resources in bytes. */
+    size_t GetCachedResourcesSize();
+
+    /**
+     * @brief Keeps a resource in the cache regardless of the memory budget.
+     *
+     * The resource does not need to be loaded yet. Pins are counted, every call needs a
+     * matching UnpinResource().
+     *
+     * @param identifier Identifier of the resource to keep resident.
+     */
+    void PinResource(const ResourceIdentifier& identifier);
+
+    /**
+     * @brief Keeps a resource in the cache regardless of the memory budget.
+     * @param filePath Virtual path of the resource to keep resident.
+     */
+    void PinResource(const std::string& filePath);
+
+    /**
+     * @brief Releases a pin taken by PinResource(), making the resource evictable again once it has none left.
+     * @param identifier Identifier of the pinned resource.
+     * @return true if the resource was pinned.
+     */
+    bool UnpinResource(const ResourceIdentifier& identifier);
+
+    /**
+     * @brief Releases a pin taken by PinResource().
+     * @param filePath Virtual path of the pinned resource.
+     * @return true if the resource was pinned.
+     */
+    bool UnpinResource(const std::string& filePath);
+
     /**
      * @brief Writes raw data into an archive and optionally evicts the stale cache entry.
      * @param identifier Identifier of the resource to write.
@@ -246,6 +374,29 @@ class ResourceManager {
      */
     std::shared_ptr<std::vector<std::shared_ptr<IResource>>> LoadResources(const ResourceFilter& filter);
 
+    /**
+     * @brief Starts loading all resources matching a glob mask across the thread pool.
+     * @param searchMask Glob pattern.
+     * @param priority   Thread-pool scheduling priority of every file.
+     * @return Handle reporting the progress and results of the load.
+     */
+    std::shared_ptr<ResourceLoadBatch> LoadResourcesBatch(const std::string& searchMask,
+                                                          BS::priority_t priority = BS::pr::normal);
+
+    /**
+     * @brief Starts loading all resources matching a filter across the thread pool.
+     *
+     * At most one file per pool thread is loading at a time. Each file is queued on its own at
+     * the given priority, so loads with a higher priority can run in between. Called from a pool
+     * thread, e.g. by a resource factory, the files are loaded before it returns instead.
+     *
+     * @param filter   ResourceFilter.
+     * @param priority Thread-pool scheduling priority of every file.
+     * @return Handle reporting the progress and results of the load.
+     */
+    std::shared_ptr<ResourceLoadBatch> LoadResourcesBatch(const ResourceFilter& filter,
+                                                          BS::priority_t priority = BS::pr::normal);
+
     /**
      * @brief Asynchronously loads all resources matching a glob mask.
      * @param searchMask Glob pattern.
@@ -379,6 +530,10 @@ class ResourceManager {
 
     /**
      * @brief Returns a type-erased raw pointer to the resource payload.
+     *
+     * The resource is exempt from the memory budget from then on, so the pointer stays valid
+     * until the resource is unloaded explicitly.
+     *
      * @param resource Shared pointer to the resource.
      * @return Void pointer to the payload, or nullptr if the resource is null.
      */
@@ -408,14 +563,77 @@ class ResourceManager {
 
     std::shared_ptr<IResource> GetCachedResource(std::variant<ResourceLoadError, std::shared_ptr<IResource>> cacheLine);
 
+    /**
+     * @brief Adds a loaded resource to the cache, unless another thread cached a usable one first.
+     * @param identifier Identifier to cache the resource under.
+     * @param resource   Loaded resource, nullptr to record that loading failed.
+     * @return The resource that is cached now.
+     */
+    std::shared_ptr<IResource> CacheResource(const ResourceIdentifier& identifier,
+                                             std::shared_ptr<IResource> resource);
+
   private:
-    std::unordered_map<ResourceIdentifier, std::variant<ResourceLoadError, std::shared_ptr<IResource>>,
-                       ResourceIdentifierHash>
-        mResourceCache;
+    // Number of independently locked parts of the cache, so loads and cache hits on different threads rarely wait
+    // for each other
+    static constexpr size_t CACHE_SHARD_COUNT = 16;
+
+    struct CacheEntry {
+        std::variant<ResourceLoadError, std::shared_ptr<IResource>> Value;
+        // Counted against the memory budget, 0 for failed loads
+        size_t Size = 0;
+        // Steady clock time of the last cache hit, updated under a shared lock
+        std::atomic<int64_t> LastUse = 0;
+    };
+
+    struct CacheShard {
+        std::shared_mutex Mutex;
+        std::unordered_map<ResourceIdentifier, CacheEntry, ResourceIdentifierHash> Entries;
+    };
+
+    // A load of a resource that is not cached yet, which other requests for the same resource wait on
+    struct LoadInFlight {
+        std::shared_future<std::shared_ptr<IResource>> Result;
+        std::thread::id Thread;
+        // Whether the loading thread belongs to mThreadPool, its nested loads then run inline
+        bool OnPool;
+    };
+
+    // Loads the next file of the batch on the calling thread
+    void LoadResourcesBatchFile(std::shared_ptr<ResourceLoadBatch> batch, const ResourceFilter& filter);
+    // Loads the next file of the batch and queues the one after it
+    void LoadResourcesBatchProcess(std::shared_ptr<ResourceLoadBatch> batch, const ResourceFilter& filter,
+                                   BS::priority_t priority);
+
+    // Reads, decodes and caches the resource at exactly the identifier's path
+    std::shared_ptr<IResource> LoadAndCacheResource(const ResourceIdentifier& identifier,
+                                                    std::shared_ptr<ResourceInitData> initData);
+    void EndLoadInFlight(const ResourceIdentifier& identifier);
+
+    CacheShard& GetCacheShard(const ResourceIdentifier& identifier);
+    // Both require the shard to be locked exclusively. Replaced and erased resources are moved to released, to be
+    // destroyed after the shard is unlocked. Destroying a resource can load others.
+    void SetCacheEntry(CacheShard& shard, const ResourceIdentifier& identifier,
+                       std::variant<ResourceLoadError, std::shared_ptr<IResource>> value,
+                       std::vector<std::shared_ptr<IResource>>& released);
+    size_t EraseCacheEntry(CacheShard& shard, const ResourceIdentifier& identifier,
+                           std::vector<std::shared_ptr<IResource>>& released);
+    // Requires no shard to be locked
+    void EvictResources();
+
+    std::array<CacheShard, CACHE_SHARD_COUNT> mCacheShards;
+    // Guards mPinnedResources and lets one thread at a time evict
+    std::mutex mEvictionMutex;
+    std::unordered_map<ResourceIdentifier, uint32_t, ResourceIdentifierHash> mPinnedResources;
+    std::atomic<size_t> mMemoryBudget = 0;
+    // Cache size up to which eviction is not retried after a pass that could not get under the budget, 0 to always
+    // try. Collecting candidates visits every cached resource, which adds up if every load did it.
+    std::atomic<size_t> mEvictionRetrySize = 0;
+    std::atomic<size_t> mCachedResourcesSize = 0;
+    std::mutex mLoadsInFlightMutex;
+    std::unordered_map<ResourceIdentifier, LoadInFlight, ResourceIdentifierHash> mLoadsInFlight;
     std::shared_ptr<ResourceLoader> mResourceLoader;
     std::shared_ptr<ArchiveManager> mArchiveManager;
     std::shared_ptr<BS::thread_pool> mThreadPool;
-    std::mutex mMutex;
     bool mAltAssetsEnabled = false;
     // Private information for which owner and archive are default.
     uintptr_t mDefaultCacheOwner = 0;
@@ -185,6 +185,12 @@ class Archive : public std::enable_shared_from_this<Archive> {
      * @param filePath Virtual path of the file to index.
      */
     void IndexFile(const std::string& filePath);
+    /**
+     * @brief Adds a file to the internal hash→path index, reusing a hash computed earlier.
+     * @param filePath Virtual path of the file to index.
+     * @param hash     CRC64 of @p filePath.
+     */
+    void IndexFile(const std::string& filePath, uint64_t hash);
     /** @brief Validates the manifest checksum and signature, setting mIsSigned / mIsChecksumValid. */
     void Validate();
 
@@ -197,5 +203,9 @@ class Archive : public std::enable_shared_from_this<Archive> {
     ArchiveManifest mManifest;
     std::string mPath;
     std::shared_ptr<std::unordered_map<uint64_t, std::string>> mHashes;
+    // Set by ArchiveManager while loading on worker threads, an unknown key then leaves validation to the loading
+    // thread instead of asking the untrusted archive handler
+    bool mDeferUntrustedPrompt = false;
+    bool mUntrustedPromptPending = false;
 };
 } // namespace Ship
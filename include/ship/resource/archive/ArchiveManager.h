@@ -23,6 +23,7 @@ class Archive;
  *
  * The handler receives a reference to the untrusted Archive and the key entry from
  * the Keystore. Return true to accept the archive anyway, or false to reject it.
+ * It is called on the thread that adds the archives, one archive at a time.
  */
 using UntrustedArchiveHandler = std::function<bool(Archive& archive, KeystoreEntry& key)>;
 #endif
@@ -135,6 +136,14 @@ class ArchiveManager {
      */
     bool HasFile(uint64_t hash);
 
+    /**
+     * @brief Returns true if any mounted archive contains alt-asset overrides.
+     *
+     * Alt assets are files under IResource::gAltAssetPrefix. When there are none, looking for
+     * an alt version of a resource can be skipped entirely.
+     */
+    bool HasAltAssets();
+
     /**
      * @brief Returns the highest-priority archive that contains the given file.
      * @param filePath Virtual path of the file.
@@ -213,6 +222,21 @@ class ArchiveManager {
      */
     static std::vector<std::string> GetArchiveListInPaths(const std::vector<std::string>& archivePaths);
 
+    /**
+     * @brief Creates an unloaded archive of the type matching the path's extension.
+     * @param archivePath Path of the archive file or folder.
+     */
+    static std::shared_ptr<Archive> CreateArchive(const std::string& archivePath);
+
+    /**
+     * @brief Loads the given archives concurrently, one thread per hardware thread at most.
+     *
+     * Archives signed with a key missing from the keystore finish validating on the calling thread after the others
+     * loaded, so the untrusted archive handler never runs on a worker thread.
+     * @param archives Archives to load. Whether each one succeeded is reported by Archive::IsLoaded.
+     */
+    static void LoadArchives(const std::vector<std::shared_ptr<Archive>>& archives);
+
     /** @brief Adds a game-version value to the internal version set. */
     void AddGameVersion(uint32_t newGameVersion);
 
@@ -226,6 +250,7 @@ class ArchiveManager {
     std::unordered_map<uint64_t, std::string> mHashes;
     std::unordered_set<std::string> mDirectories;
     std::unordered_map<uint64_t, std::shared_ptr<Archive>> mFileToArchive;
+    bool mHasAltAssets = false;
 #ifdef ENABLE_SCRIPTING
     UntrustedArchiveHandler mUntrustedArchiveHandler;
 #endif
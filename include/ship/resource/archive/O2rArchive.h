@@ -5,7 +5,9 @@
 #include <string>
 #include <stdint.h>
 #include <string>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "zip.h"
@@ -13,6 +15,7 @@
 #include "ship/resource/File.h"
 #include "ship/resource/Resource.h"
 #include "ship/resource/archive/Archive.h"
+#include "ship/utils/filesystemtools/MappedFile.h"
 
 namespace Ship {
 struct File;
@@ -26,6 +29,14 @@ struct File;
  *
  * To improve concurrent read throughput a pool of `zip_t*` handles is maintained
  * internally; reads acquire a handle from the pool and return it when done.
+ *
+ * Every entry is indexed by the CRC64 of its path when the archive is opened, so
+ * loads don't search names. The archive file is also memory mapped; entries stored
+ * without compression are read straight from the mapping, without going through libzip.
+ *
+ * When an index cache directory is set, the index is saved there after an archive is
+ * indexed. An archive whose size, modification time and end of central directory
+ * still match its cache is opened from the cache, without libzip reading its entries.
  */
 class O2rArchive final : virtual public Archive {
   public:
@@ -70,13 +81,60 @@ class O2rArchive final : virtual public Archive {
      */
     std::shared_ptr<File> LoadFile(uint64_t hash);
 
+    /**
+     * @brief Sets the directory entry indexes are cached in. Empty disables the cache.
+     *
+     * Applies to archives opened afterwards, so set it before any archive is opened.
+     * @param directory Directory to store the index cache files in.
+     */
+    static void SetIndexCacheDirectory(const std::string& directory);
+
+    /** @brief Returns the directory entry indexes are cached in, empty if the cache is disabled. */
+    static const std::string& GetIndexCacheDirectory();
+
   private:
+    /** @brief Location of an entry in the archive, looked up when it is opened. */
+    struct Entry {
+        zip_uint64_t Index;
+        /** @brief Uncompressed size, UINT64_MAX if the central directory could not be read. */
+        uint64_t Size = UINT64_MAX;
+        uint64_t CompressedSize = 0;
+        uint64_t LocalHeaderOffset = 0;
+        /** @brief Stored without compression or encryption, so it can be read from the mapping. */
+        bool Stored = false;
+    };
+
+    /** @brief Every file entry in the archive keyed by the CRC64 of its path, with the mapped archive file. */
+    struct EntryIndex {
+        std::unique_ptr<MappedFile> Mapping;
+        std::unordered_map<uint64_t, Entry> Entries;
+    };
+
+    /** @brief Indexes the entries of mZipArchive and maps the archive file. */
+    std::shared_ptr<const EntryIndex> BuildEntryIndex();
+    /** @brief Fills in sizes and offsets from the mapped central directory, returns false if it is malformed. */
+    static bool ReadCentralDirectory(EntryIndex& index);
+    /** @brief Returns the path of the index cache file for this archive, empty if the cache is disabled. */
+    std::string GetIndexCachePath();
+    /** @brief Maps the archive and reads its index from the cache, or returns nullptr if the cache is stale. */
+    std::shared_ptr<const EntryIndex> LoadIndexCache();
+    /** @brief Writes an index built from mZipArchive to the cache. */
+    void SaveIndexCache(const EntryIndex& index);
+    /** @brief Returns the current entry index, which stays valid for the caller while the archive is rewritten. */
+    std::shared_ptr<const EntryIndex> GetEntryIndex();
+    /** @brief Reads an entry, from the mapping if it is stored and through libzip otherwise. */
+    std::shared_ptr<File> LoadEntry(const EntryIndex& index, const Entry& entry, uint64_t hash);
+    /** @brief Copies a stored entry out of the mapped archive, or returns nullptr if its local header is invalid. */
+    static std::shared_ptr<File> LoadStoredEntry(const MappedFile& mapping, const Entry& entry);
     /** @brief Acquires a zip_t* handle from the pool, opening a new one if the pool is empty. */
     zip_t* GetZipHandle();
     /** @brief Returns a zip_t* handle back to the pool for reuse. */
     void ReleaseZipHandle(zip_t* handle);
+    // Only opened when the index is built or the archive is written, archives opened from the index cache have none
     zip_t* mZipArchive;
     std::mutex mPoolMutex;
     std::vector<zip_t*> mZipArchivePool;
+    // Replaced while the archive is rewritten, loads keep the index they started with alive. Guarded by mPoolMutex.
+    std::shared_ptr<const EntryIndex> mEntryIndex;
 };
 } // namespace Ship
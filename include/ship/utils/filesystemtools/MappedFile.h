@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Ship {
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The mapping stays valid for the lifetime of the object. Pages are only read from disk when they are first touched,
+ * so mapping a large file is cheap.
+ */
+class MappedFile {
+  public:
+    /**
+     * @brief Maps the file at @p path. Check IsOpen() for success.
+     * @param path Path of the file to map.
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** @brief Returns true if the file was mapped. Empty files can't be mapped. */
+    bool IsOpen() const;
+
+    /** @brief Returns the start of the mapped file contents, or nullptr if the file is not mapped. */
+    const uint8_t* GetData() const;
+
+    /** @brief Returns the size of the mapped file in bytes. */
+    size_t GetSize() const;
+
+  private:
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+};
+
+} // namespace Ship
@@ -39,6 +39,28 @@ IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARA
 
 namespace Fast {
 
+// Read every frame while laying out the game view
+static Ship::CVarHandle<int32_t> sLowResMode(CVAR_LOW_RES_MODE, 0);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionEnabled(CVAR_PREFIX_ADVANCED_RESOLUTION ".Enabled", 0);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionPixelPerfectMode(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".PixelPerfectMode", 0);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionIgnoreAspectCorrection(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".IgnoreAspectCorrection", 0);
+static Ship::CVarHandle<float> sAdvancedResolutionAspectRatioX(CVAR_PREFIX_ADVANCED_RESOLUTION ".AspectRatioX", 16.0f);
+static Ship::CVarHandle<float> sAdvancedResolutionAspectRatioY(CVAR_PREFIX_ADVANCED_RESOLUTION ".AspectRatioY", 9.0f);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionVerticalPixelCount(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".VerticalPixelCount", 480);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionVerticalResolutionToggle(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".VerticalResolutionToggle", 0);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionIntegerScaleFitAutomatically(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.FitAutomatically", 0);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionIntegerScaleFactor(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.Factor", 1);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionIntegerScaleNeverExceedBounds(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.NeverExceedBounds", 1);
+static Ship::CVarHandle<int32_t> sAdvancedResolutionIntegerScaleExceedBoundsBy(
+    CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.ExceedBoundsBy", 0);
+
 Fast3dGui::Fast3dGui() : Ship::Gui() {
 }
 
@@ -322,12 +344,11 @@ void Fast3dGui::CalculateGameViewport() {
     mInterpreter.lock()->mGameWindowViewport.width = (int16_t)size.x;
     mInterpreter.lock()->mGameWindowViewport.height = (int16_t)size.y;
 
-    if (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_PREFIX_ADVANCED_RESOLUTION ".Enabled",
-                                                                        0)) {
+    if (sAdvancedResolutionEnabled.Get()) {
         ApplyResolutionChanges();
     }
 
-    switch (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_LOW_RES_MODE, 0)) {
+    switch (sLowResMode.Get()) {
         case 1: { // N64 Mode
             mInterpreter.lock()->mCurDimensions.width = 320;
             mInterpreter.lock()->mCurDimensions.height = 240;
@@ -371,17 +392,13 @@ void Fast3dGui::DrawGame() {
     ImVec2 mainPos = ImGui::GetWindowPos();
     ImVec2 size = ImGui::GetContentRegionAvail();
     ImVec2 pos = ImVec2(0, 0);
-    if (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_LOW_RES_MODE, 0) ==
-        1) { // N64 Mode takes priority
+    if (sLowResMode.Get() == 1) { // N64 Mode takes priority
         const float sw = size.y * 320.0f / 240.0f;
         pos = ImVec2(floor(size.x / 2 - sw / 2), 0);
         size = ImVec2(sw, size.y);
-    } else if (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-                   CVAR_PREFIX_ADVANCED_RESOLUTION ".Enabled", 0)) {
-        if (!Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-                CVAR_PREFIX_ADVANCED_RESOLUTION ".PixelPerfectMode", 0)) {
-            if (!Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-                    CVAR_PREFIX_ADVANCED_RESOLUTION ".IgnoreAspectCorrection", 0)) {
+    } else if (sAdvancedResolutionEnabled.Get()) {
+        if (!sAdvancedResolutionPixelPerfectMode.Get()) {
+            if (!sAdvancedResolutionIgnoreAspectCorrection.Get()) {
                 float sWdth =
                     size.y * mInterpreter.lock()->mCurDimensions.width / mInterpreter.lock()->mCurDimensions.height;
                 float sHght =
@@ -420,14 +437,10 @@ void Fast3dGui::DrawGame() {
 void Fast3dGui::ApplyResolutionChanges() {
     ImVec2 size = ImGui::GetContentRegionAvail();
 
-    const float aspectRatioX = Ship::Context::GetInstance()->GetConsoleVariables()->GetFloat(
-        CVAR_PREFIX_ADVANCED_RESOLUTION ".AspectRatioX", 16.0f);
-    const float aspectRatioY = Ship::Context::GetInstance()->GetConsoleVariables()->GetFloat(
-        CVAR_PREFIX_ADVANCED_RESOLUTION ".AspectRatioY", 9.0f);
-    const uint32_t verticalPixelCount = Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-        CVAR_PREFIX_ADVANCED_RESOLUTION ".VerticalPixelCount", 480);
-    const bool verticalResolutionToggle = Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-        CVAR_PREFIX_ADVANCED_RESOLUTION ".VerticalResolutionToggle", 0);
+    const float aspectRatioX = sAdvancedResolutionAspectRatioX.Get();
+    const float aspectRatioY = sAdvancedResolutionAspectRatioY.Get();
+    const uint32_t verticalPixelCount = sAdvancedResolutionVerticalPixelCount.Get();
+    const bool verticalResolutionToggle = sAdvancedResolutionVerticalResolutionToggle.Get();
 
     const bool aspectRatioIsEnabled = (aspectRatioX > 0.0f) && (aspectRatioY > 0.0f);
 
@@ -477,13 +490,10 @@ void Fast3dGui::ApplyResolutionChanges() {
 }
 
 int16_t Fast3dGui::GetIntegerScaleFactor() {
-    if (!Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-            CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.FitAutomatically", 0)) {
-        int16_t factor = Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-            CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.Factor", 1);
+    if (!sAdvancedResolutionIntegerScaleFitAutomatically.Get()) {
+        int16_t factor = sAdvancedResolutionIntegerScaleFactor.Get();
 
-        if (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-                CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.NeverExceedBounds", 1)) {
+        if (sAdvancedResolutionIntegerScaleNeverExceedBounds.Get()) {
             if (((float)mInterpreter.lock()->mGameWindowViewport.height /
                  mInterpreter.lock()->mGameWindowViewport.width) <
                 ((float)mInterpreter.lock()->mCurDimensions.height / mInterpreter.lock()->mCurDimensions.width)) {
@@ -514,8 +524,7 @@ int16_t Fast3dGui::GetIntegerScaleFactor() {
             factor = mInterpreter.lock()->mGameWindowViewport.width / mInterpreter.lock()->mCurDimensions.width;
         }
 
-        factor += Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(
-            CVAR_PREFIX_ADVANCED_RESOLUTION ".IntegerScale.ExceedBoundsBy", 0);
+        factor += sAdvancedResolutionIntegerScaleExceedBoundsBy.Get();
 
         if (factor < 1) {
             factor = 1;
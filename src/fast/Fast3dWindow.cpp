@@ -101,6 +101,8 @@ void Fast3dWindow::Init() {
     InitWindowManager();
     mGfxDebugger = std::make_shared<GfxDebugger>();
     mInterpreter->SetGfxDebugger(mGfxDebugger);
+    mGfxTraceRecorder = std::make_shared<GfxTraceRecorder>();
+    mInterpreter->SetGfxTraceRecorder(mGfxTraceRecorder);
     mInterpreter->Init(mWindowManagerApi, mRenderingApi, Ship::Context::GetInstance()->GetName().c_str(), isFullscreen,
                        width, height, posX, posY);
     mWindowManagerApi->SetFullscreenChangedCallback(OnFullscreenChanged);
@@ -131,6 +133,14 @@ uint16_t Fast3dWindow::GetPixelDepth(float x, float y) {
     return mInterpreter->GetPixelDepth(x, y);
 }
 
+uint16_t Fast3dWindow::GetPixelDepthAsync(float x, float y) {
+    return mInterpreter->GetPixelDepthAsync(x, y);
+}
+
+void Fast3dWindow::GetPixelDepthBatchAsync(const float* xs, const float* ys, uint16_t* depths, size_t count) {
+    mInterpreter->GetPixelDepthBatchAsync(xs, ys, depths, count);
+}
+
 void Fast3dWindow::InitWindowManager() {
     SetWindowBackend(GetSavedWindowBackend());
 
@@ -160,7 +170,11 @@ void Fast3dWindow::InitWindowManager() {
 }
 
 void Fast3dWindow::SetTextureFilter(FilteringMode filteringMode) {
-    mInterpreter->GetCurrentRenderingAPI()->SetTextureFilter(filteringMode);
+    mInterpreter->SetTextureFilter(filteringMode);
+}
+
+GfxFramebufferPoolStats Fast3dWindow::GetFramebufferPoolStats() {
+    return mInterpreter->GetCurrentRenderingAPI()->GetFramebufferPoolStats();
 }
 
 void Fast3dWindow::EnableSRGBMode() {
@@ -168,7 +182,7 @@ void Fast3dWindow::EnableSRGBMode() {
 }
 
 void Fast3dWindow::SetRendererUCode(UcodeHandlers ucode) {
-    gfx_set_target_ucode(ucode);
+    mInterpreter->SetTargetUcode(ucode);
 }
 
 void Fast3dWindow::Close() {
@@ -216,6 +230,10 @@ bool Fast3dWindow::DrawAndRunGraphicsCommands(Gfx* commands, const std::unordere
     return true;
 }
 
+FrameLimiter* Fast3dWindow::GetFrameLimiter() {
+    return mWindowManagerApi->GetFrameLimiter();
+}
+
 void Fast3dWindow::HandleEvents() {
     mWindowManagerApi->HandleEvents();
 }
@@ -442,4 +460,8 @@ std::shared_ptr<GfxDebugger> Fast3dWindow::GetGfxDebugger() const {
     return mGfxDebugger;
 }
 
+std::shared_ptr<GfxTraceRecorder> Fast3dWindow::GetGfxTraceRecorder() const {
+    return mGfxTraceRecorder;
+}
+
 } // namespace Fast
@@ -0,0 +1,185 @@
+#include "fast/FrameLimiter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <ctime>
+#endif
+
+#define NANOSECONDS_IN_SECOND 1000000000LL
+#define NANOSECONDS_IN_MILLISECOND 1000000LL
+
+namespace Fast {
+
+void FrameJitterHistogram::Record(int64_t jitterNs) {
+    mBuckets[GetBucketIndex(jitterNs)]++;
+    mCount++;
+    mSum += (double)jitterNs;
+    mSumOfSquares += (double)jitterNs * (double)jitterNs;
+    mMaxAbsolute = std::max(mMaxAbsolute, jitterNs < 0 ? -jitterNs : jitterNs);
+}
+
+void FrameJitterHistogram::Reset() {
+    *this = FrameJitterHistogram();
+}
+
+uint64_t FrameJitterHistogram::GetCount() const {
+    return mCount;
+}
+
+uint64_t FrameJitterHistogram::GetBucket(size_t bucket) const {
+    return bucket < BUCKET_COUNT ? mBuckets[bucket] : 0;
+}
+
+int64_t FrameJitterHistogram::GetBucketCenter(size_t bucket) {
+    return ((int64_t)bucket - (int64_t)(BUCKET_COUNT / 2)) * BUCKET_WIDTH_NS;
+}
+
+size_t FrameJitterHistogram::GetBucketIndex(int64_t jitterNs) {
+    const int64_t index = std::llround((double)jitterNs / BUCKET_WIDTH_NS) + (int64_t)(BUCKET_COUNT / 2);
+    return (size_t)std::clamp<int64_t>(index, 0, BUCKET_COUNT - 1);
+}
+
+double FrameJitterHistogram::GetMean() const {
+    return mCount != 0 ? mSum / mCount : 0.0;
+}
+
+double FrameJitterHistogram::GetStandardDeviation() const {
+    if (mCount == 0) {
+        return 0.0;
+    }
+    const double mean = GetMean();
+    return std::sqrt(std::max(mSumOfSquares / mCount - mean * mean, 0.0));
+}
+
+int64_t FrameJitterHistogram::GetMaxAbsolute() const {
+    return mMaxAbsolute;
+}
+
+FrameLimiter::FrameLimiter() {
+#ifdef _WIN32
+    // The timer wakes up within about 1 ms of the deadline
+    mSpinMargin = 3 * NANOSECONDS_IN_MILLISECOND / 2;
+    // Use high-resolution timer by default on Windows 10 (so that NtSetTimerResolution (...) hacks are not needed)
+    mTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    // Fallback to low resolution timer if unsupported by the OS
+    if (mTimer == nullptr) {
+        mTimer = CreateWaitableTimer(nullptr, false, nullptr);
+    }
+#elif defined(__APPLE__)
+    // macOS scheduler interval, don't trust sysctl on macOS
+    mSpinMargin = NANOSECONDS_IN_MILLISECOND;
+#else
+    // Covers the default 50 us timer slack and typical wake up latency
+    mSpinMargin = NANOSECONDS_IN_MILLISECOND / 2;
+#endif
+}
+
+FrameLimiter::~FrameLimiter() {
+#ifdef _WIN32
+    if (mTimer != nullptr) {
+        CloseHandle(mTimer);
+    }
+#endif
+}
+
+void FrameLimiter::Wait(int32_t targetFps) {
+    const int64_t interval = NANOSECONDS_IN_SECOND / std::max(targetFps, 1);
+    const int64_t next = mPreviousDeadline + interval;
+    int64_t now = ReadClock();
+    const bool early = now < next;
+
+    if (early) {
+        SleepUntil(next - mSpinMargin, now);
+        now = ReadClock();
+        while (now < next) {
+            std::this_thread::yield();
+            now = ReadClock();
+        }
+    }
+
+    // A change of the target rate changes the interval mid frame, so that one is not representative
+    if (mPreviousWake != 0 && targetFps == mPreviousTargetFps) {
+        mJitter.Record(now - mPreviousWake - interval);
+    }
+    mPreviousWake = now;
+    mPreviousTargetFps = targetFps;
+
+    // In case it takes some time for the application to wake up after sleep, don't let that slow down the framerate.
+    // Frames that are late on their own start a new schedule.
+    mPreviousDeadline = early && now - next < NANOSECONDS_IN_MILLISECOND ? next : now;
+}
+
+int64_t FrameLimiter::ReadClock() {
+    return Now();
+}
+
+void FrameLimiter::SleepUntil(int64_t deadline, int64_t now) {
+    if (deadline <= now) {
+        return;
+    }
+
+#ifdef _WIN32
+    LARGE_INTEGER li;
+    li.QuadPart = -(deadline - now) / 100;
+    SetWaitableTimer(mTimer, &li, 0, nullptr, nullptr, false);
+    WaitForSingleObject(mTimer, INFINITE);
+#else
+#ifdef __linux__
+    if (mAbsoluteDeadline) {
+        const timespec spec = { (time_t)(deadline / NANOSECONDS_IN_SECOND), (long)(deadline % NANOSECONDS_IN_SECOND) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &spec, nullptr) == EINTR) {
+        }
+        return;
+    }
+#endif
+    const int64_t left = deadline - now;
+    const timespec spec = { (time_t)(left / NANOSECONDS_IN_SECOND), (long)(left % NANOSECONDS_IN_SECOND) };
+    nanosleep(&spec, nullptr);
+#endif
+}
+
+void FrameLimiter::SetSpinMargin(int64_t marginNs) {
+    mSpinMargin = std::max<int64_t>(marginNs, 0);
+}
+
+int64_t FrameLimiter::GetSpinMargin() const {
+    return mSpinMargin;
+}
+
+void FrameLimiter::SetAbsoluteDeadline(bool absolute) {
+    mAbsoluteDeadline = absolute;
+}
+
+bool FrameLimiter::IsAbsoluteDeadline() const {
+    return mAbsoluteDeadline;
+}
+
+const FrameJitterHistogram& FrameLimiter::GetJitterHistogram() const {
+    return mJitter;
+}
+
+void FrameLimiter::ResetJitterHistogram() {
+    mJitter.Reset();
+}
+
+int64_t FrameLimiter::Now() {
+#ifdef __linux__
+    // clock_nanosleep sleeps against this clock
+    timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return (int64_t)spec.tv_sec * NANOSECONDS_IN_SECOND + spec.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+} // namespace Fast
@@ -48,6 +48,8 @@ using namespace Microsoft::WRL; // For ComPtr
 
 namespace Fast {
 
+static Ship::CVarHandle<int32_t> sZFightingMode(CVAR_Z_FIGHTING_MODE, 0);
+
 GfxRenderingAPIDX11::~GfxRenderingAPIDX11() {
 }
 
@@ -704,7 +706,7 @@ void GfxRenderingAPIDX11::DrawTriangles(float buf_vbo[], size_t buf_vbo_len, siz
         const int noVanishFactor = 100;
         float SSDB = -2;
 
-        switch (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_Z_FIGHTING_MODE, 0)) {
+        switch (sZFightingMode.Get()) {
             case 1: // scaled z-fighting (N64 mode like)
                 SSDB = -1.0f * (float)mRenderTargetHeight / n64modeFactor;
                 break;
@@ -1111,7 +1113,6 @@ void GfxRenderingAPIDX11::ReadFramebufferToCPU(int fb_id, uint32_t width, uint32
 
 void GfxRenderingAPIDX11::SetTextureFilter(FilteringMode mode) {
     mCurrentFilterMode = mode;
-    gfx_texture_cache_clear();
 }
 
 FilteringMode GfxRenderingAPIDX11::GetTextureFilter() {
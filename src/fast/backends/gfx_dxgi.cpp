@@ -59,6 +59,8 @@ using QWORD = uint64_t; // For NEXTRAWINPUTBLOCK
 
 namespace Fast {
 
+static Ship::CVarHandle<int32_t> sVsyncEnabled(CVAR_VSYNC_ENABLED, 1);
+
 void GfxWindowBackendDXGI::LoadDxgi() {
     dxgi_module = LoadLibraryW(L"dxgi.dll");
     *(FARPROC*)&CreateDXGIFactory1 = GetProcAddress(dxgi_module, "CreateDXGIFactory1");
@@ -918,7 +920,7 @@ void GfxWindowBackendDXGI::SwapBuffersBegin() {
     // mLengthInVsyncFrames (now mVsyncEnabled) was used as present interval. Present interval >1 (aka fractional
     // V-Sync) breaks VRR and introduces even more input lag than capping via normal V-Sync does. Get the present
     // interval the user wants instead (V-Sync toggle).
-    mVsyncEnabled = Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_VSYNC_ENABLED, 1) ? 1 : 0;
+    mVsyncEnabled = sVsyncEnabled.Get() ? 1 : 0;
 
     LARGE_INTEGER t;
     QueryPerformanceCounter(&t);
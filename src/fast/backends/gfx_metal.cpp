@@ -43,6 +43,9 @@
 // MARK: - Helpers
 namespace Fast {
 
+static Ship::CVarHandle<int32_t> sZFightingMode(CVAR_Z_FIGHTING_MODE, 0);
+static Ship::CVarHandle<int32_t> sMsaaValue("gMSAAValue", 1);
+
 static MTL::SamplerAddressMode gfx_cm_to_metal(uint32_t val) {
     switch (val) {
         case G_TX_NOMIRROR | G_TX_CLAMP:
@@ -480,7 +483,7 @@ void GfxRenderingAPIMetal::DrawTriangles(float buf_vbo[], size_t buf_vbo_len, si
         const int n64modeFactor = 120;
         const int noVanishFactor = 100;
         float SSDB = -2;
-        switch (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_Z_FIGHTING_MODE, 0)) {
+        switch (sZFightingMode.Get()) {
             case 1: // scaled z-fighting (N64 mode like)
                 SSDB = -1.0f * (float)mRenderTargetHeight / n64modeFactor;
                 break;
@@ -690,7 +693,7 @@ void GfxRenderingAPIMetal::SetupScreenFramebuffer(uint32_t width, uint32_t heigh
     mCurrentDrawable = nullptr;
     mCurrentDrawable = mLayer->nextDrawable();
 
-    bool msaa_enabled = Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger("gMSAAValue", 1) > 1;
+    bool msaa_enabled = sMsaaValue.Get() > 1;
 
     FramebufferMetal& fb = mFramebuffers[0];
     TextureDataMetal& tex = mTextures[fb.mTextureId];
@@ -800,8 +803,7 @@ void GfxRenderingAPIMetal::UpdateFramebufferParameters(int fb_id, uint32_t width
             MTL::RenderPassDescriptor* render_pass_descriptor = MTL::RenderPassDescriptor::renderPassDescriptor();
 
             bool fb_msaa_enabled = (msaa_level > 1);
-            bool game_msaa_enabled =
-                Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger("gMSAAValue", 1) > 1;
+            bool game_msaa_enabled = sMsaaValue.Get() > 1;
 
             if (fb_msaa_enabled) {
                 render_pass_descriptor->colorAttachments()->object(0)->setTexture(tex.msaaTexture);
@@ -1263,7 +1265,6 @@ void GfxRenderingAPIMetal::ReadFramebufferToCPU(int fb_id, uint32_t width, uint3
 
 void GfxRenderingAPIMetal::SetTextureFilter(FilteringMode mode) {
     mCurrentFilterMode = mode;
-    gfx_texture_cache_clear();
 }
 
 FilteringMode GfxRenderingAPIMetal::GetTextureFilter() {
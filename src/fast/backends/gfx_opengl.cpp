@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <map>
 #include <unordered_map>
 
@@ -28,6 +29,9 @@
 #include "ship/config/ConsoleVariable.h"
 
 namespace Fast {
+
+static Ship::CVarHandle<int32_t> sZFightingMode(CVAR_Z_FIGHTING_MODE, 0);
+
 int GfxRenderingAPIOGL::GetMaxTextureSize() {
     GLint max_texture_size;
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
@@ -672,7 +676,7 @@ void GfxRenderingAPIOGL::DrawTriangles(float buf_vbo[], size_t buf_vbo_len, size
             const int n64modeFactor = 120;
             const int noVanishFactor = 100;
             GLfloat SSDB = -2;
-            switch (Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_Z_FIGHTING_MODE, 0)) {
+            switch (sZFightingMode.Get()) {
                 // scaled z-fighting (N64 mode like)
                 case 1:
                     if (mFrameBuffers.size() >
@@ -758,23 +762,7 @@ void GfxRenderingAPIOGL::FinishRender() {
 }
 
 int GfxRenderingAPIOGL::CreateFramebuffer() {
-    GLuint clrbuf;
-    glGenTextures(1, &clrbuf);
-    glBindTexture(GL_TEXTURE_2D, clrbuf);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    GLuint clrbufMsaa;
-    glGenRenderbuffers(1, &clrbufMsaa);
-
-    GLuint rbo;
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, 1, 1);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
+    // Attachments are picked up from the storage pool once the framebuffer is given a size
     GLuint fbo;
     glGenFramebuffers(1, &fbo);
 
@@ -782,13 +770,77 @@ int GfxRenderingAPIOGL::CreateFramebuffer() {
     mFrameBuffers.resize(i + 1);
 
     mFrameBuffers[i].fbo = fbo;
-    mFrameBuffers[i].clrbuf = clrbuf;
-    mFrameBuffers[i].clrbufMsaa = clrbufMsaa;
-    mFrameBuffers[i].rbo = rbo;
+    mFrameBuffers[i].clrbuf = 0;
+    mFrameBuffers[i].clrbufMsaa = 0;
+    mFrameBuffers[i].rbo = 0;
 
     return i;
 }
 
+GLuint GfxRenderingAPIOGL::AcquireFramebufferStorage(const FramebufferStorageKey& key) {
+    for (auto it = mFramebufferStoragePool.begin(); it != mFramebufferStoragePool.end(); ++it) {
+        if (it->first == key) {
+            GLuint name = it->second;
+            mFramebufferStoragePool.erase(it);
+            mFramebufferPoolStats.hits++;
+            mFramebufferPoolStats.pooledCount--;
+            mFramebufferPoolStats.pooledBytes -= key.GetSizeBytes();
+            return name;
+        }
+    }
+
+    mFramebufferPoolStats.misses++;
+
+    GLuint name;
+    if (key.IsTexture()) {
+        glGenTextures(1, &name);
+        glBindTexture(GL_TEXTURE_2D, name);
+        glTexImage2D(GL_TEXTURE_2D, 0, key.format, key.width, key.height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    } else {
+        glGenRenderbuffers(1, &name);
+        glBindRenderbuffer(GL_RENDERBUFFER, name);
+        if (key.msaa_level <= 1) {
+            glRenderbufferStorage(GL_RENDERBUFFER, key.format, key.width, key.height);
+        } else {
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, key.msaa_level, key.format, key.width, key.height);
+        }
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+    return name;
+}
+
+void GfxRenderingAPIOGL::ReleaseFramebufferStorage(const FramebufferStorageKey& key, GLuint name) {
+    if (name == 0) {
+        return;
+    }
+
+    mFramebufferStoragePool.emplace_back(key, name);
+    mFramebufferPoolStats.pooledCount++;
+    mFramebufferPoolStats.pooledBytes += key.GetSizeBytes();
+
+    // Drop the least recently released storage once the pool is full
+    while (mFramebufferStoragePool.size() > MAX_POOLED_FRAMEBUFFER_STORAGE ||
+           mFramebufferPoolStats.pooledBytes > MAX_POOLED_FRAMEBUFFER_BYTES) {
+        const auto& [oldKey, oldName] = mFramebufferStoragePool.front();
+        if (oldKey.IsTexture()) {
+            glDeleteTextures(1, &oldName);
+        } else {
+            glDeleteRenderbuffers(1, &oldName);
+        }
+        mFramebufferPoolStats.evictions++;
+        mFramebufferPoolStats.pooledCount--;
+        mFramebufferPoolStats.pooledBytes -= oldKey.GetSizeBytes();
+        mFramebufferStoragePool.pop_front();
+    }
+}
+
+GfxFramebufferPoolStats GfxRenderingAPIOGL::GetFramebufferPoolStats() {
+    return mFramebufferPoolStats;
+}
+
 void GfxRenderingAPIOGL::UpdateFramebufferParameters(int fb_id, uint32_t width, uint32_t height, uint32_t msaa_level,
                                                      bool opengl_invertY, bool render_target, bool has_depth_buffer,
                                                      bool can_extract_depth) {
@@ -796,40 +848,40 @@ void GfxRenderingAPIOGL::UpdateFramebufferParameters(int fb_id, uint32_t width,
 
     width = std::max(width, 1U);
     height = std::max(height, 1U);
-    msaa_level = std::min(msaa_level, (uint32_t)mMaxMsaaLevel);
+    msaa_level = std::clamp(msaa_level, 1U, (uint32_t)std::max(mMaxMsaaLevel, 1));
 
     glBindFramebuffer(GL_FRAMEBUFFER, fb.fbo);
 
     if (fb_id != 0) {
-        if (fb.width != width || fb.height != height || fb.msaa_level != msaa_level) {
-            if (msaa_level <= 1) {
-                glBindTexture(GL_TEXTURE_2D, fb.clrbuf);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-                glBindTexture(GL_TEXTURE_2D, 0);
-                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fb.clrbuf, 0);
+        bool shapeChanged = fb.width != width || fb.height != height || fb.msaa_level != msaa_level;
+
+        // Instead of reallocating in place, hand the old attachments back to the pool and take ones of the new
+        // shape, so switching back and forth between sizes reuses the storage
+        if (shapeChanged) {
+            if (fb.msaa_level <= 1) {
+                ReleaseFramebufferStorage({ GL_RGB8, fb.width, fb.height, 1 }, fb.clrbuf);
+                fb.clrbuf = 0;
             } else {
-                glBindRenderbuffer(GL_RENDERBUFFER, fb.clrbufMsaa);
-                glRenderbufferStorageMultisample(GL_RENDERBUFFER, msaa_level, GL_RGB8, width, height);
-                glBindRenderbuffer(GL_RENDERBUFFER, 0);
-                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, fb.clrbufMsaa);
+                ReleaseFramebufferStorage({ GL_RGB8, fb.width, fb.height, fb.msaa_level }, fb.clrbufMsaa);
+                fb.clrbufMsaa = 0;
             }
-        }
 
-        if (has_depth_buffer &&
-            (fb.width != width || fb.height != height || fb.msaa_level != msaa_level || !fb.has_depth_buffer)) {
-            glBindRenderbuffer(GL_RENDERBUFFER, fb.rbo);
             if (msaa_level <= 1) {
-                glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+                fb.clrbuf = AcquireFramebufferStorage({ GL_RGB8, width, height, 1 });
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fb.clrbuf, 0);
             } else {
-                glRenderbufferStorageMultisample(GL_RENDERBUFFER, msaa_level, GL_DEPTH24_STENCIL8, width, height);
+                fb.clrbufMsaa = AcquireFramebufferStorage({ GL_RGB8, width, height, msaa_level });
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, fb.clrbufMsaa);
             }
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
         }
 
-        if (!fb.has_depth_buffer && has_depth_buffer) {
+        if (shapeChanged || fb.has_depth_buffer != has_depth_buffer) {
+            ReleaseFramebufferStorage({ GL_DEPTH24_STENCIL8, fb.width, fb.height, fb.msaa_level }, fb.rbo);
+            fb.rbo = 0;
+            if (has_depth_buffer) {
+                fb.rbo = AcquireFramebufferStorage({ GL_DEPTH24_STENCIL8, width, height, msaa_level });
+            }
             glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, fb.rbo);
-        } else if (fb.has_depth_buffer && !has_depth_buffer) {
-            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, 0);
         }
     }
 
@@ -1020,6 +1072,47 @@ void GfxRenderingAPIOGL::ReadFramebufferToCPU(int fb_id, uint32_t width, uint32_
     glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffers[mCurrentFrameBuffer].fbo);
 }
 
+void GfxRenderingAPIOGL::GatherPixelDepth(const FramebufferOGL& fb,
+                                          const std::set<std::pair<float, float>>& coordinates) {
+    if (mPixelDepthRbSize < coordinates.size()) {
+        // Resizing a renderbuffer seems broken with Intel's driver, so recreate one instead.
+        glBindFramebuffer(GL_FRAMEBUFFER, mPixelDepthFb);
+        glDeleteRenderbuffers(1, &mPixelDepthRb);
+        glGenRenderbuffers(1, &mPixelDepthRb);
+        glBindRenderbuffer(GL_RENDERBUFFER, mPixelDepthRb);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, coordinates.size(), 1);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, mPixelDepthRb);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        mPixelDepthRbSize = coordinates.size();
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mPixelDepthFb);
+
+    // Disabled for blit
+    if (mLastScissorEnabled != 0) {
+        mLastScissorEnabled = 0;
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    size_t i = 0;
+    for (const auto& coord : coordinates) {
+        int x = coord.first;
+        int y = coord.second;
+        if (fb.invertY) {
+            y = fb.height - y;
+        }
+        glBlitFramebuffer(x, y, x + 1, y + 1, i, 0, i + 1, 1, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+        ++i;
+    }
+
+    if (mLastScissorEnabled != 1) {
+        mLastScissorEnabled = 1;
+        glEnable(GL_SCISSOR_TEST);
+    }
+}
+
 std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff>
 GfxRenderingAPIOGL::GetPixelDepth(int fb_id, const std::set<std::pair<float, float>>& coordinates) {
     std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> res;
@@ -1039,37 +1132,7 @@ GfxRenderingAPIOGL::GetPixelDepth(int fb_id, const std::set<std::pair<float, flo
 #endif
         res.emplace(*coordinates.begin(), (depth_stencil_value >> 18) << 2);
     } else {
-        if (mPixelDepthRbSize < coordinates.size()) {
-            // Resizing a renderbuffer seems broken with Intel's driver, so recreate one instead.
-            glBindFramebuffer(GL_FRAMEBUFFER, mPixelDepthFb);
-            glDeleteRenderbuffers(1, &mPixelDepthRb);
-            glGenRenderbuffers(1, &mPixelDepthRb);
-            glBindRenderbuffer(GL_RENDERBUFFER, mPixelDepthRb);
-            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, coordinates.size(), 1);
-            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, mPixelDepthRb);
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-            mPixelDepthRbSize = coordinates.size();
-        }
-
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, fb.fbo);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mPixelDepthFb);
-
-        glDisable(GL_SCISSOR_TEST); // needed for the blit operation
-
-        {
-            size_t i = 0;
-            for (const auto& coord : coordinates) {
-                int x = coord.first;
-                int y = coord.second;
-                if (fb.invertY) {
-                    y = fb.height - y;
-                }
-                glBlitFramebuffer(x, y, x + 1, y + 1, i, 0, i + 1, 1, GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT,
-                                  GL_NEAREST);
-                ++i;
-            }
-        }
+        GatherPixelDepth(fb, coordinates);
 
         glBindFramebuffer(GL_READ_FRAMEBUFFER, mPixelDepthFb);
         std::vector<uint32_t> depth_stencil_values(coordinates.size());
@@ -1089,8 +1152,128 @@ GfxRenderingAPIOGL::GetPixelDepth(int fb_id, const std::set<std::pair<float, flo
     return res;
 }
 
+void GfxRenderingAPIOGL::RequestPixelDepthAsync(int fb_id, const std::set<std::pair<float, float>>& coordinates) {
+#ifdef USE_OPENGLES
+    // Depth can't be read into a pack buffer on GLES, so there would be nothing to collect. Take the synchronous path.
+    GfxRenderingAPI::RequestPixelDepthAsync(fb_id, coordinates);
+    return;
+#endif
+    if (coordinates.empty()) {
+        return;
+    }
+
+    // Only one request is kept in flight; a request that was never collected is simply replaced.
+    if (mPixelDepthFence != nullptr) {
+        glDeleteSync(mPixelDepthFence);
+        mPixelDepthFence = nullptr;
+    }
+
+    GatherPixelDepth(mFrameBuffers[fb_id], coordinates);
+
+    if (mPixelDepthPbo == 0) {
+        glGenBuffers(1, &mPixelDepthPbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mPixelDepthPbo);
+    if (mPixelDepthPboSize < coordinates.size()) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(uint32_t) * coordinates.size(), nullptr, GL_STREAM_READ);
+        mPixelDepthPboSize = coordinates.size();
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, mPixelDepthFb);
+    // With a pack buffer bound, the read is queued on the GPU instead of stalling until it completes
+    glReadPixels(0, 0, coordinates.size(), 1, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    mPixelDepthFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    mPixelDepthAsyncCoords.assign(coordinates.begin(), coordinates.end());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffers[mCurrentFrameBuffer].fbo);
+}
+
+std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> GfxRenderingAPIOGL::CollectPixelDepthAsync() {
+#ifdef USE_OPENGLES
+    return GfxRenderingAPI::CollectPixelDepthAsync();
+#endif
+    std::unordered_map<std::pair<float, float>, uint16_t, hash_pair_ff> res;
+
+    if (mPixelDepthFence == nullptr) {
+        return res;
+    }
+
+    // The request was issued a frame ago, so the fence has normally been signaled already
+    glClientWaitSync(mPixelDepthFence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(mPixelDepthFence);
+    mPixelDepthFence = nullptr;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mPixelDepthPbo);
+    const uint32_t* depth_stencil_values = (const uint32_t*)glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, sizeof(uint32_t) * mPixelDepthAsyncCoords.size(), GL_MAP_READ_BIT);
+    if (depth_stencil_values != nullptr) {
+        for (size_t i = 0; i < mPixelDepthAsyncCoords.size(); i++) {
+            res.emplace(mPixelDepthAsyncCoords[i], (depth_stencil_values[i] >> 18) << 2);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    mPixelDepthAsyncCoords.clear();
+    return res;
+}
+
+bool GfxRenderingAPIOGL::ReadFramebufferToCPUAsync(int fb_id, uint32_t width, uint32_t height, uint16_t* rgba16_buf) {
+    if (fb_id >= (int)mFrameBuffers.size()) {
+        return false;
+    }
+
+    bool hasData = false;
+
+    // Consume the previous request before reusing the pack buffer for the next one
+    if (mReadbackFence != nullptr) {
+        glClientWaitSync(mReadbackFence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(mReadbackFence);
+        mReadbackFence = nullptr;
+
+        if (mReadbackFbId == fb_id && mReadbackWidth == width && mReadbackHeight == height) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, mReadbackPbo);
+            const uint8_t* rgba8 =
+                (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, width * height * 4, GL_MAP_READ_BIT);
+            if (rgba8 != nullptr) {
+                for (uint32_t i = 0; i < width * height; i++) {
+                    uint8_t r = (rgba8[i * 4 + 0] >> 3) & 0x1F;
+                    uint8_t g = (rgba8[i * 4 + 1] >> 3) & 0x1F;
+                    uint8_t b = (rgba8[i * 4 + 2] >> 3) & 0x1F;
+                    uint8_t a = rgba8[i * 4 + 3] ? 1 : 0;
+                    rgba16_buf[i] = (r << 11) | (g << 6) | (b << 1) | a;
+                }
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                hasData = true;
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+    }
+
+    if (mReadbackPbo == 0) {
+        glGenBuffers(1, &mReadbackPbo);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mReadbackPbo);
+    if (mReadbackPboSize < (size_t)width * height * 4) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * 4, nullptr, GL_STREAM_READ);
+        mReadbackPboSize = (size_t)width * height * 4;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffers[fb_id].fbo);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    mReadbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    mReadbackFbId = fb_id;
+    mReadbackWidth = width;
+    mReadbackHeight = height;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mFrameBuffers[mCurrentFrameBuffer].fbo);
+
+    return hasData;
+}
+
 void GfxRenderingAPIOGL::SetTextureFilter(FilteringMode mode) {
-    gfx_texture_cache_clear();
     mCurrentFilterMode = mode;
 }
 
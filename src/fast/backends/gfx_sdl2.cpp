@@ -44,13 +44,15 @@
 #endif
 
 #define GFX_BACKEND_NAME "SDL"
-#define _100NANOSECONDS_IN_SECOND 10000000
 
 #ifdef _WIN32
 LONG_PTR SDL_WndProc;
 #endif
 
 namespace Fast {
+
+static Ship::CVarHandle<int32_t> sVsyncEnabled(CVAR_VSYNC_ENABLED, 1);
+
 const SDL_Scancode lus_to_sdl_table[] = {
     SDL_SCANCODE_UNKNOWN,
     SDL_SCANCODE_ESCAPE,
@@ -279,14 +281,6 @@ void GfxWindowBackendSDL2::GetActiveWindowRefreshRate(uint32_t* refresh_rate) {
     *refresh_rate = mode.refresh_rate != 0 ? mode.refresh_rate : 60;
 }
 
-static uint64_t previous_time;
-#ifdef _WIN32
-static HANDLE mTimer;
-#endif
-
-#define FRAME_INTERVAL_US_NUMERATOR 1000000
-#define FRAME_INTERVAL_US_DENOMINATOR (mTargetFps)
-
 void GfxWindowBackendSDL2::Close() {
     mIsRunning = false;
 }
@@ -350,21 +344,13 @@ void GfxWindowBackendSDL2::Init(const char* gameName, const char* gfxApiName, bo
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
 #endif
 
-#ifdef _WIN32
-    // Use high-resolution mTimer by default on Windows 10 (so that NtSetTimerResolution (...) hacks are not needed)
-    mTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
-    // Fallback to low resolution mTimer if unsupported by the OS
-    if (mTimer == nullptr) {
-        mTimer = CreateWaitableTimer(nullptr, false, nullptr);
-    }
-#endif
-
 #ifdef __OpenBSD__
     int sysctlname[2] = { CTL_KERN, KERN_CLOCKRATE };
     struct clockinfo clockinfo;
     size_t clockinfo_size = sizeof(struct clockinfo);
     if (sysctl(sysctlname, 2, &clockinfo, &clockinfo_size, NULL, 0) != -1) {
-        mBsdTick = clockinfo.tick;
+        // Sleeps are rounded up to the kernel tick, so spin for one tick
+        mFrameLimiter.SetSpinMargin((int64_t)clockinfo.tick * 1000);
     }
 #endif
 
@@ -684,56 +670,12 @@ bool GfxWindowBackendSDL2::IsFrameReady() {
     return true;
 }
 
-static uint64_t qpc_to_100ns(uint64_t qpc) {
-    const uint64_t qpc_freq = SDL_GetPerformanceFrequency();
-    return qpc / qpc_freq * _100NANOSECONDS_IN_SECOND + qpc % qpc_freq * _100NANOSECONDS_IN_SECOND / qpc_freq;
-}
-
-void GfxWindowBackendSDL2::SyncFramerateWithTime() const {
-    uint64_t t = qpc_to_100ns(SDL_GetPerformanceCounter());
-
-    const int64_t next = previous_time + 10 * FRAME_INTERVAL_US_NUMERATOR / FRAME_INTERVAL_US_DENOMINATOR;
-    int64_t left = next - t;
-#ifdef _WIN32
-    // We want to exit a bit early, so we can busy-wait the rest to never miss the deadline
-    left -= 15000UL;
-#elif defined(__APPLE__)
-    // Use macOS scheduler interval on macOS. Don't trust sysctl on macOS
-    left -= 10000UL;
-#elif defined(__OpenBSD__)
-    left -= mBsdTick * 10;
-#endif
-    if (left > 0) {
-#ifndef _WIN32
-        const timespec spec = { 0, left * 100 };
-        nanosleep(&spec, nullptr);
-#else
-        // The accuracy of this mTimer seems to usually be within +- 1.0 ms
-        LARGE_INTEGER li;
-        li.QuadPart = -left;
-        SetWaitableTimer(mTimer, &li, 0, nullptr, nullptr, false);
-        WaitForSingleObject(mTimer, INFINITE);
-#endif
-    }
-
-    t = qpc_to_100ns(SDL_GetPerformanceCounter());
-#ifdef _WIN32
-    while (t < next) {
-        YieldProcessor(); // TODO: Find a way for other compilers, OSes and architectures
-        t = qpc_to_100ns(SDL_GetPerformanceCounter());
-    }
-#endif
-    if (left > 0 && t - next < 10000) {
-        // In case it takes some time for the application to wake up after sleep,
-        // or inaccurate mTimer,
-        // don't let that slow down the framerate.
-        t = next;
-    }
-    previous_time = t;
+void GfxWindowBackendSDL2::SyncFramerateWithTime() {
+    mFrameLimiter.Wait(mTargetFps);
 }
 
 void GfxWindowBackendSDL2::SwapBuffersBegin() {
-    bool nextVsyncEnabled = Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger(CVAR_VSYNC_ENABLED, 1);
+    bool nextVsyncEnabled = sVsyncEnabled.Get();
 
     if (mVsyncEnabled != nextVsyncEnabled) {
         mVsyncEnabled = nextVsyncEnabled;
@@ -787,5 +729,9 @@ void GfxWindowBackendSDL2::Destroy() {
 bool GfxWindowBackendSDL2::IsFullscreen() {
     return mFullScreen;
 }
+
+FrameLimiter* GfxWindowBackendSDL2::GetFrameLimiter() {
+    return &mFrameLimiter;
+}
 } // namespace Fast
 #endif
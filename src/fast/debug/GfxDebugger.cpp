@@ -38,7 +38,7 @@ void GfxDebugger::DebugDisplayList(F3DGfx* cmds) {
     mBreakPoint = { cmds };
 }
 
-bool GfxDebugger::HasBreakPoint(const std::vector<const F3DGfx*>& path) const {
+bool GfxDebugger::HasBreakPoint(std::span<const F3DGfx* const> path) const {
     if (path.size() != mBreakPoint.size())
         return false;
 
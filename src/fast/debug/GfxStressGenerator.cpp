@@ -0,0 +1,442 @@
+#include "fast/debug/GfxStressGenerator.h"
+#include "fast/types.h"
+#include "fast/ucodehandlers.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+namespace Fast {
+
+namespace {
+
+// The generated scene targets the native resolution, the interpreter scales it like game content
+constexpr uint32_t SCREEN_W = 320;
+constexpr uint32_t SCREEN_H = 240;
+constexpr uint32_t SEGMENT_SIZE = 1 << 24;
+
+// Inputs valid in every slot of both the color and the alpha combiner: TEXEL0, PRIMITIVE, SHADE, ENVIRONMENT
+constexpr uint32_t COMBINER_INPUTS[] = { 1, 3, 4, 5 };
+
+uintptr_t Op(int8_t opcode) {
+    return (uintptr_t)(uint8_t)opcode << 24;
+}
+
+uintptr_t SegAddress(uint32_t segment, uint32_t offset) {
+    return ((uintptr_t)segment << 24) | offset | 1;
+}
+
+// Texel size in nibbles
+uint32_t TexelNibbles(uint8_t siz) {
+    return 1u << siz;
+}
+
+} // namespace
+
+F3DGfx* GfxStressWorkload::GetRootDisplayList() {
+    return mRoot.data();
+}
+
+const std::vector<F3DGfx>& GfxStressWorkload::GetRootCommands() const {
+    return mRoot;
+}
+
+const std::vector<F3DGfx>& GfxStressWorkload::GetDisplayListArena() const {
+    return mDisplayLists;
+}
+
+const GfxStressStats& GfxStressWorkload::GetStats() const {
+    return mStats;
+}
+
+GfxStressGenerator::GfxStressGenerator(const GfxStressConfig& config) : mConfig(config), mRng(config.seed) {
+    if (mConfig.textureFormats.empty()) {
+        mConfig.textureFormats.push_back({ G_IM_FMT_RGBA, G_IM_SIZ_16b });
+    }
+    mConfig.textureCount = std::max<uint32_t>(mConfig.textureCount, 1);
+    mConfig.combinerCount = std::max<uint32_t>(mConfig.combinerCount, 1);
+}
+
+uint32_t GfxStressGenerator::Next(GfxStressRange range) {
+    if (range.max <= range.min) {
+        return range.min;
+    }
+
+    // Plain modulo instead of std::uniform_int_distribution, whose output differs between standard libraries
+    return range.min + (uint32_t)(mRng() % ((uint64_t)range.max - range.min + 1));
+}
+
+bool GfxStressGenerator::Chance(float probability) {
+    return (mRng() >> 8) * (1.0f / (1 << 24)) < probability;
+}
+
+uint32_t GfxStressGenerator::Allocate(std::vector<uint64_t>& arena, size_t size) {
+    const size_t offset = arena.size() * sizeof(uint64_t);
+    arena.resize(arena.size() + (size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    return (uint32_t)std::min<size_t>(offset, UINT32_MAX);
+}
+
+uint8_t* GfxStressGenerator::Data(std::vector<uint64_t>& arena, uint32_t offset) {
+    return reinterpret_cast<uint8_t*>(arena.data()) + offset;
+}
+
+void GfxStressGenerator::WriteMatrix(uint32_t offset, const float matrix[4][4]) {
+    uint8_t* dst = Data(mWorkload->mData, offset);
+#ifndef GBI_FLOATS
+    int32_t fixed[4][4];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            fixed[i][j] = (int32_t)(matrix[i][j] * 65536.0f);
+        }
+    }
+
+    uint32_t words[16];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j += 2) {
+            words[i * 2 + j / 2] = ((uint32_t)fixed[i][j] & 0xFFFF0000) | ((uint32_t)fixed[i][j + 1] >> 16);
+            words[8 + i * 2 + j / 2] = ((uint32_t)fixed[i][j] << 16) | ((uint32_t)fixed[i][j + 1] & 0xFFFF);
+        }
+    }
+    memcpy(dst, words, sizeof(words));
+#else
+    memcpy(dst, matrix, sizeof(float) * 16);
+#endif
+}
+
+void GfxStressGenerator::Emit(std::vector<F3DGfx>& list, uintptr_t w0, uintptr_t w1) {
+    F3DGfx cmd{};
+    cmd.words.w0 = w0;
+    cmd.words.w1 = w1;
+    list.push_back(cmd);
+}
+
+void GfxStressGenerator::GenerateTextures() {
+    std::vector<uint64_t>& arena = mWorkload->mTextures;
+
+    for (uint32_t i = 0; i < mConfig.textureCount; i++) {
+        const GfxStressTextureFormat format =
+            mConfig.textureFormats[Next({ 0, (uint32_t)mConfig.textureFormats.size() - 1 })];
+        Texture tex = {};
+        tex.fmt = format.fmt;
+        tex.siz = std::min<uint8_t>(format.siz, G_IM_SIZ_32b);
+        tex.width = std::bit_floor(std::clamp<uint32_t>(Next(mConfig.textureSize), 4, 256));
+        tex.height = std::bit_floor(std::clamp<uint32_t>(Next(mConfig.textureSize), 4, 256));
+
+        // CI textures share TMEM with their palette
+        const bool ci = tex.fmt == G_IM_FMT_CI;
+        const uint32_t limit = ci ? 2048 : 4096;
+        while (tex.width * tex.height * TexelNibbles(tex.siz) / 2 > limit) {
+            if (tex.width >= tex.height) {
+                tex.width /= 2;
+            } else {
+                tex.height /= 2;
+            }
+        }
+
+        const uint32_t size = tex.width * tex.height * TexelNibbles(tex.siz) / 2;
+        tex.offset = Allocate(arena, size);
+        for (uint32_t b = 0; b < size; b++) {
+            Data(arena, tex.offset)[b] = (uint8_t)mRng();
+        }
+
+        if (ci) {
+            tex.paletteCount = tex.siz == G_IM_SIZ_4b ? 16 : 256;
+            tex.paletteOffset = Allocate(arena, tex.paletteCount * sizeof(uint16_t));
+            for (uint32_t b = 0; b < tex.paletteCount * sizeof(uint16_t); b++) {
+                Data(arena, tex.paletteOffset)[b] = (uint8_t)mRng();
+            }
+        }
+
+        mTexturePool.push_back(tex);
+    }
+}
+
+void GfxStressGenerator::GenerateCombiners() {
+    const uint32_t last = (uint32_t)std::size(COMBINER_INPUTS) - 1;
+
+    for (uint32_t i = 0; i < mConfig.combinerCount; i++) {
+        uint32_t in[8];
+        for (uint32_t& input : in) {
+            input = COMBINER_INPUTS[Next({ 0, last })];
+        }
+
+        // Same equation in both cycles, like the 1-cycle modes games use
+        const uint32_t a = in[0], b = in[1], c = in[2], d = in[3];
+        const uint32_t aa = in[4], ab = in[5], ac = in[6], ad = in[7];
+        Combiner combiner;
+        combiner.w0 = (a << 20) | (c << 15) | (aa << 12) | (ac << 9) | (a << 5) | c;
+        combiner.w1 = (b << 28) | (d << 15) | (ab << 12) | (ad << 9) | (b << 24) | (aa << 21) | (ac << 18) | (d << 6) |
+                      (ab << 3) | ad;
+        mCombinerPool.push_back(combiner);
+    }
+}
+
+void GfxStressGenerator::EmitTextureLoad(std::vector<F3DGfx>& list, const Texture& tex) {
+    const uint32_t nibbles = TexelNibbles(tex.siz);
+    const uint32_t loadSiz = tex.siz == G_IM_SIZ_32b ? G_IM_SIZ_32b : G_IM_SIZ_16b;
+    const uint32_t loadBytes = tex.siz == G_IM_SIZ_32b ? 4 : 2;
+    const uint32_t size = tex.width * tex.height * nibbles / 2;
+    const uint32_t masks = std::countr_zero(tex.width);
+    const uint32_t maskt = std::countr_zero(tex.height);
+
+    // gDPSetTextureLUT followed by gDPLoadTLUT_pal16/pal256 for color indexed textures
+    const uintptr_t otherModeH = Op(F3DEX2_G_SETOTHERMODE_H) | ((32 - G_MDSFT_TEXTLUT - 2) << 8) | (2 - 1);
+    if (tex.fmt == G_IM_FMT_CI) {
+        Emit(list, otherModeH, G_TT_RGBA16);
+        Emit(list, Op(RDP_G_SETTIMG) | (G_IM_FMT_RGBA << 21) | (G_IM_SIZ_16b << 19),
+             SegAddress(GfxStressWorkload::TEXTURE_SEGMENT, tex.paletteOffset));
+        Emit(list, Op(RDP_G_RDPTILESYNC), 0);
+        Emit(list, Op(RDP_G_SETTILE) | 256, G_TX_LOADTILE << 24);
+        Emit(list, Op(RDP_G_RDPLOADSYNC), 0);
+        Emit(list, Op(RDP_G_LOADTLUT), (G_TX_LOADTILE << 24) | ((tex.paletteCount - 1) << 14));
+        Emit(list, Op(RDP_G_RDPPIPESYNC), 0);
+    } else {
+        Emit(list, otherModeH, G_TT_NONE);
+    }
+
+    // gDPLoadTextureBlock: one LoadBlock into TMEM, then the render tile describes the real format
+    const uint32_t lineWords = std::max<uint32_t>(1, tex.width * nibbles / 16);
+    const uint32_t dxt = (2048 + lineWords - 1) / lineWords;
+    const uint32_t lrs = (size + loadBytes - 1) / loadBytes - 1;
+    const uint32_t lineBytes = tex.siz == G_IM_SIZ_32b ? tex.width * 2 : tex.width * nibbles / 2;
+    const uint32_t line = (lineBytes + 7) >> 3;
+
+    Emit(list, Op(RDP_G_SETTIMG) | (tex.fmt << 21) | (loadSiz << 19),
+         SegAddress(GfxStressWorkload::TEXTURE_SEGMENT, tex.offset));
+    Emit(list, Op(RDP_G_SETTILE) | (tex.fmt << 21) | (loadSiz << 19), G_TX_LOADTILE << 24);
+    Emit(list, Op(RDP_G_RDPLOADSYNC), 0);
+    Emit(list, Op(RDP_G_LOADBLOCK), (G_TX_LOADTILE << 24) | (lrs << 12) | dxt);
+    Emit(list, Op(RDP_G_RDPPIPESYNC), 0);
+    Emit(list, Op(RDP_G_SETTILE) | (tex.fmt << 21) | (tex.siz << 19) | (line << 9),
+         (G_TX_RENDERTILE << 24) | (maskt << 14) | (masks << 4));
+    Emit(list, Op(RDP_G_SETTILESIZE),
+         (G_TX_RENDERTILE << 24) | (((tex.width - 1) << 2) << 12) | ((tex.height - 1) << 2));
+}
+
+void GfxStressGenerator::EmitTriangles(std::vector<F3DGfx>& list, uint32_t count) {
+    GfxStressStats& stats = mWorkload->mStats;
+
+    while (count > 0) {
+        const uint32_t n = std::clamp<uint32_t>(Next(mConfig.verticesPerLoad), 3, 32);
+        const uint32_t offset = Allocate(mWorkload->mVertices, n * sizeof(F3DVtx));
+        F3DVtx* vtx = reinterpret_cast<F3DVtx*>(Data(mWorkload->mVertices, offset));
+        for (uint32_t i = 0; i < n; i++) {
+            vtx[i].v.ob[0] = (int16_t)Next({ 0, 2048 }) - 1024;
+            vtx[i].v.ob[1] = (int16_t)Next({ 0, 2048 }) - 1024;
+            vtx[i].v.ob[2] = (int16_t)Next({ 0, 1024 }) - 512;
+            vtx[i].v.flag = 0;
+            vtx[i].v.tc[0] = (int16_t)Next({ 0, 64 << 5 });
+            vtx[i].v.tc[1] = (int16_t)Next({ 0, 64 << 5 });
+            vtx[i].v.cn[0] = (uint8_t)mRng();
+            vtx[i].v.cn[1] = (uint8_t)mRng();
+            vtx[i].v.cn[2] = (uint8_t)mRng();
+            vtx[i].v.cn[3] = 0xFF;
+        }
+        Emit(list, Op(F3DEX2_G_VTX) | (n << 12) | (n << 1), SegAddress(GfxStressWorkload::VERTEX_SEGMENT, offset));
+        stats.vertices += n;
+
+        // Meshes reference each loaded vertex about twice
+        uint32_t tris = std::min(count, n * 2);
+        count -= tris;
+        stats.triangles += tris;
+
+        auto triangle = [&]() {
+            const uint32_t a = Next({ 0, n - 1 });
+            uint32_t b, c;
+            do {
+                b = Next({ 0, n - 1 });
+            } while (b == a);
+            do {
+                c = Next({ 0, n - 1 });
+            } while (c == a || c == b);
+            return (uintptr_t)((a * 2) << 16) | ((b * 2) << 8) | (c * 2);
+        };
+        for (; tris >= 2; tris -= 2) {
+            const uintptr_t first = triangle();
+            Emit(list, Op(F3DEX2_G_TRI2) | first, triangle());
+        }
+        if (tris == 1) {
+            Emit(list, Op(F3DEX2_G_TRI1) | triangle(), 0);
+        }
+    }
+}
+
+void GfxStressGenerator::EmitTexRect(std::vector<F3DGfx>& list, const Texture& tex) {
+    const uint32_t w = std::min(tex.width, SCREEN_W);
+    const uint32_t h = std::min(tex.height, SCREEN_H);
+    const uint32_t ulx = Next({ 0, SCREEN_W - w }) << 2;
+    const uint32_t uly = Next({ 0, SCREEN_H - h }) << 2;
+    const uint32_t lrx = ulx + (w << 2);
+    const uint32_t lry = uly + (h << 2);
+
+    Emit(list, Op(RDP_G_TEXRECT) | (lrx << 12) | lry, (G_TX_RENDERTILE << 24) | (ulx << 12) | uly);
+    Emit(list, Op(F3DEX2_G_RDPHALF_1), 0);
+    Emit(list, Op(F3DEX2_G_RDPHALF_2), (1 << 10 << 16) | (1 << 10));
+    mWorkload->mStats.texRects++;
+}
+
+uint32_t GfxStressGenerator::GenerateDisplayList(uint32_t depth) {
+    GfxStressStats& stats = mWorkload->mStats;
+    std::vector<F3DGfx> list;
+
+    stats.displayLists++;
+    stats.maxDepth = std::max(stats.maxDepth, depth);
+
+    if (depth == 0) {
+        float mtx[4][4] = {};
+        mtx[0][0] = mtx[1][1] = mtx[2][2] = mtx[3][3] = 1.0f;
+        mtx[3][0] = (float)Next({ 0, 512 }) - 256.0f;
+        mtx[3][1] = (float)Next({ 0, 512 }) - 256.0f;
+        const uint32_t offset = Allocate(mWorkload->mData, sizeof(Mtx));
+        WriteMatrix(offset, mtx);
+        Emit(list, Op(F3DEX2_G_MTX) | (((sizeof(Mtx) - 1) / 8) << 19) | ((F3DEX2_G_MTX_LOAD) ^ F3DEX2_G_MTX_PUSH),
+             SegAddress(GfxStressWorkload::DATA_SEGMENT, offset));
+    }
+
+    const uint32_t stateChanges = Next(mConfig.stateChangesPerList);
+    for (uint32_t i = 0; i < stateChanges; i++) {
+        const Combiner& combiner = mCombinerPool[Next({ 0, (uint32_t)mCombinerPool.size() - 1 })];
+        const Texture& tex = mTexturePool[Next({ 0, (uint32_t)mTexturePool.size() - 1 })];
+
+        Emit(list, Op(RDP_G_RDPPIPESYNC), 0);
+        Emit(list, Op(RDP_G_SETCOMBINE) | combiner.w0, combiner.w1);
+        EmitTextureLoad(list, tex);
+        EmitTriangles(list, Next(mConfig.trianglesPerStateChange));
+        if (Chance(mConfig.texRectDensity)) {
+            EmitTexRect(list, tex);
+        }
+        stats.stateChanges++;
+
+        if (depth < mConfig.maxNestingDepth && Chance(mConfig.nestingProbability)) {
+            const uint32_t child = GenerateDisplayList(depth + 1);
+            Emit(list, Op(F3DEX2_G_DL), SegAddress(GfxStressWorkload::DISPLAY_LIST_SEGMENT, child));
+        }
+    }
+
+    Emit(list, Op(F3DEX2_G_ENDDL), 0);
+
+    std::vector<F3DGfx>& arena = mWorkload->mDisplayLists;
+    const size_t offset = arena.size() * sizeof(F3DGfx);
+    arena.insert(arena.end(), list.begin(), list.end());
+    return (uint32_t)std::min<size_t>(offset, UINT32_MAX);
+}
+
+void GfxStressGenerator::EmitRoot(const std::vector<uint32_t>& objects, const std::vector<uint32_t>& backgrounds) {
+    std::vector<F3DGfx>& root = mWorkload->mRoot;
+    std::vector<uint64_t>& data = mWorkload->mData;
+
+    const std::pair<uint32_t, uintptr_t> segments[] = {
+        { GfxStressWorkload::VERTEX_SEGMENT, (uintptr_t)mWorkload->mVertices.data() },
+        { GfxStressWorkload::TEXTURE_SEGMENT, (uintptr_t)mWorkload->mTextures.data() },
+        { GfxStressWorkload::DATA_SEGMENT, (uintptr_t)data.data() },
+        { GfxStressWorkload::DISPLAY_LIST_SEGMENT, (uintptr_t)mWorkload->mDisplayLists.data() },
+    };
+    for (const auto& [segment, address] : segments) {
+        Emit(root, Op(F3DEX2_G_MOVEWORD) | (G_MW_SEGMENT << 16) | (segment * 4), address);
+    }
+
+    // The viewport and projection are allocated first in the data segment
+    Emit(root, Op(F3DEX2_G_MOVEMEM) | (((sizeof(F3DVp) - 1) / 8) << 19) | F3DEX2_G_MV_VIEWPORT,
+         SegAddress(GfxStressWorkload::DATA_SEGMENT, 0));
+    Emit(root,
+         Op(F3DEX2_G_MTX) | (((sizeof(Mtx) - 1) / 8) << 19) |
+             ((F3DEX2_G_MTX_PROJECTION | F3DEX2_G_MTX_LOAD) ^ F3DEX2_G_MTX_PUSH),
+         SegAddress(GfxStressWorkload::DATA_SEGMENT, sizeof(F3DVp)));
+    Emit(root, Op(F3DEX2_G_GEOMETRYMODE) | 0xFFFFFF, G_ZBUFFER | G_SHADE | F3DEX2_G_SHADING_SMOOTH);
+    Emit(root, Op(F3DEX2_G_TEXTURE) | (G_TX_RENDERTILE << 8) | (1 << 1), 0xFFFFFFFF);
+
+    // Backgrounds come first, like the S2DEX scenes games draw under their 3D layer. The S2DEX commands take direct
+    // pointers, which are only stable now that every arena has its final size.
+    if (!backgrounds.empty()) {
+        Emit(root, Op(F3DEX2_G_LOAD_UCODE) | ucode_s2dex, 0);
+        for (size_t i = 0; i < backgrounds.size(); i++) {
+            F3DuObjBg* bg = reinterpret_cast<F3DuObjBg*>(Data(data, backgrounds[i]));
+            Emit(root, Op(i % 2 == 0 ? F3DEX2_G_BG_1CYC : F3DEX2_G_BG_COPY), (uintptr_t)bg);
+        }
+        Emit(root, Op(F3DEX2_G_LOAD_UCODE) | ucode_f3dex2, 0);
+    }
+
+    for (uint32_t object : objects) {
+        Emit(root, Op(F3DEX2_G_DL), SegAddress(GfxStressWorkload::DISPLAY_LIST_SEGMENT, object));
+    }
+
+    Emit(root, Op(F3DEX2_G_ENDDL), 0);
+}
+
+std::unique_ptr<GfxStressWorkload> GfxStressGenerator::Generate() {
+    mWorkload = std::make_unique<GfxStressWorkload>();
+    mTexturePool.clear();
+    mCombinerPool.clear();
+    mRng.seed(mConfig.seed);
+
+    std::vector<uint64_t>& data = mWorkload->mData;
+
+    F3DVp vp = {};
+    vp.vp.vscale[0] = vp.vp.vtrans[0] = SCREEN_W / 2 * 4;
+    vp.vp.vscale[1] = vp.vp.vtrans[1] = SCREEN_H / 2 * 4;
+    vp.vp.vscale[2] = vp.vp.vtrans[2] = G_MAXZ / 2;
+    memcpy(Data(data, Allocate(data, sizeof(F3DVp))), &vp, sizeof(vp));
+
+    float projection[4][4] = {};
+    projection[0][0] = projection[1][1] = projection[2][2] = 1.0f / 1024.0f;
+    projection[3][3] = 1.0f;
+    WriteMatrix(Allocate(data, sizeof(Mtx)), projection);
+
+    GenerateTextures();
+    GenerateCombiners();
+
+    std::vector<uint32_t> objects;
+    for (uint32_t i = 0; i < mConfig.objectCount; i++) {
+        objects.push_back(GenerateDisplayList(0));
+    }
+
+    // Full screen RGBA16 images, the only format G_BG_COPY supports
+    std::vector<uint32_t> backgrounds;
+    std::vector<uint32_t> images;
+    for (uint32_t i = 0; i < mConfig.backgroundCount; i++) {
+        const uint32_t size = SCREEN_W * SCREEN_H * sizeof(uint16_t);
+        images.push_back(Allocate(mWorkload->mTextures, size));
+        for (uint32_t b = 0; b < size; b++) {
+            Data(mWorkload->mTextures, images.back())[b] = (uint8_t)mRng();
+        }
+        backgrounds.push_back(Allocate(data, sizeof(F3DuObjBg)));
+    }
+    mWorkload->mStats.backgrounds = backgrounds.size();
+
+    const size_t arenaSizes[] = {
+        mWorkload->mVertices.size() * sizeof(uint64_t),
+        mWorkload->mTextures.size() * sizeof(uint64_t),
+        data.size() * sizeof(uint64_t),
+        mWorkload->mDisplayLists.size() * sizeof(F3DGfx),
+    };
+    for (size_t size : arenaSizes) {
+        if (size > SEGMENT_SIZE) {
+            SPDLOG_ERROR("Stress workload needs {} bytes in one segment, reduce the workload size", size);
+            return nullptr;
+        }
+        mWorkload->mStats.segmentBytes += size;
+    }
+
+    for (size_t i = 0; i < backgrounds.size(); i++) {
+        F3DuObjBg* bg = reinterpret_cast<F3DuObjBg*>(Data(data, backgrounds[i]));
+        memset(bg, 0, sizeof(F3DuObjBg));
+        bg->b.imageW = SCREEN_W << 2;
+        bg->b.imageH = SCREEN_H << 2;
+        bg->b.frameW = SCREEN_W << 2;
+        bg->b.frameH = SCREEN_H << 2;
+        bg->b.imagePtr = reinterpret_cast<unsigned long long int*>(Data(mWorkload->mTextures, images[i]));
+        bg->b.imageLoad = G_BGLT_LOADBLOCK;
+        bg->b.imageFmt = G_IM_FMT_RGBA;
+        bg->b.imageSiz = G_IM_SIZ_16b;
+    }
+
+    EmitRoot(objects, backgrounds);
+
+    mWorkload->mStats.displayLists++;
+    mWorkload->mStats.commands = mWorkload->mRoot.size() + mWorkload->mDisplayLists.size();
+
+    return std::move(mWorkload);
+}
+
+} // namespace Fast
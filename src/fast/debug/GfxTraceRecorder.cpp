@@ -0,0 +1,166 @@
+#include "fast/debug/GfxTraceRecorder.h"
+#include "fast/interpreter.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <spdlog/fmt/fmt.h>
+
+namespace Fast {
+
+namespace {
+
+constexpr char TRACE_MAGIC[8] = { 'L', 'U', 'S', 'G', 'B', 'I', 'T', 'R' };
+constexpr uint32_t TRACE_VERSION = 1;
+
+struct GfxTraceFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t count;
+};
+
+} // namespace
+
+GfxTraceRecorder::GfxTraceRecorder(size_t capacity) {
+    capacity = std::bit_ceil(std::max<size_t>(capacity, 1));
+    mSlots = std::make_unique<Slot[]>(capacity);
+    mMask = capacity - 1;
+}
+
+void GfxTraceRecorder::SetEnabled(bool enabled) {
+    mEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+void GfxTraceRecorder::Record(int8_t opcode, uint8_t ucode, uintptr_t w0, uintptr_t w1, size_t depth) {
+    const uint64_t index = mHead.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = mSlots[index & mMask];
+
+    // Claim the slot. It is skipped when another producer is still writing it or a newer entry has taken it, which
+    // only happens when the ring wraps around a producer that was preempted mid-record.
+    uint64_t sequence = slot.Sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 || sequence > index * 2 ||
+        !slot.Sequence.compare_exchange_strong(sequence, index * 2 + 1, std::memory_order_relaxed)) {
+        return;
+    }
+    // Readers that see any of the fields below also see the slot as being written
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.Timestamp.store((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count(),
+                         std::memory_order_relaxed);
+    slot.W0.store(w0, std::memory_order_relaxed);
+    slot.W1.store(w1, std::memory_order_relaxed);
+    slot.Info.store((uint32_t)std::min<size_t>(depth, UINT16_MAX) | (uint32_t)(uint8_t)opcode << 16 |
+                        (uint32_t)ucode << 24,
+                    std::memory_order_relaxed);
+
+    slot.Sequence.store(index * 2 + 2, std::memory_order_release);
+}
+
+void GfxTraceRecorder::Clear() {
+    mStart.store(mHead.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+size_t GfxTraceRecorder::GetCapacity() const {
+    return mMask + 1;
+}
+
+uint64_t GfxTraceRecorder::GetRecordedCount() const {
+    const uint64_t start = mStart.load(std::memory_order_relaxed);
+    return mHead.load(std::memory_order_relaxed) - start;
+}
+
+std::vector<GfxTraceEntry> GfxTraceRecorder::Snapshot() const {
+    const uint64_t start = mStart.load(std::memory_order_relaxed);
+    const uint64_t head = mHead.load(std::memory_order_relaxed);
+    const uint64_t count = std::min<uint64_t>(head - start, GetCapacity());
+
+    std::vector<GfxTraceEntry> entries;
+    entries.reserve(count);
+    for (uint64_t i = head - count; i < head; i++) {
+        const Slot& slot = mSlots[i & mMask];
+        const uint64_t sequence = slot.Sequence.load(std::memory_order_acquire);
+        if (sequence != i * 2 + 2) {
+            continue;
+        }
+
+        GfxTraceEntry entry{};
+        entry.timestamp = slot.Timestamp.load(std::memory_order_relaxed);
+        entry.w0 = slot.W0.load(std::memory_order_relaxed);
+        entry.w1 = slot.W1.load(std::memory_order_relaxed);
+        const uint32_t info = slot.Info.load(std::memory_order_relaxed);
+        entry.depth = (uint16_t)info;
+        entry.opcode = (int8_t)(info >> 16);
+        entry.ucode = (uint8_t)(info >> 24);
+
+        // A producer that claimed the slot meanwhile may have stored some of the fields
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.Sequence.load(std::memory_order_relaxed) != sequence) {
+            continue;
+        }
+        entries.push_back(entry);
+    }
+
+    return entries;
+}
+
+bool GfxTraceRecorder::Dump(const std::string& path) const {
+    const std::vector<GfxTraceEntry> entries = Snapshot();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        SPDLOG_ERROR("Failed to open GBI trace file {}", path);
+        return false;
+    }
+
+    GfxTraceFileHeader header{};
+    memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    header.entrySize = sizeof(GfxTraceEntry);
+    header.count = entries.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(GfxTraceEntry));
+
+    return out.good();
+}
+
+bool GfxTraceRecorder::Load(const std::string& path, std::vector<GfxTraceEntry>& entries) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    GfxTraceFileHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in.good() || memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 ||
+        header.version != TRACE_VERSION || header.entrySize != sizeof(GfxTraceEntry)) {
+        return false;
+    }
+
+    entries.resize(header.count);
+    in.read(reinterpret_cast<char*>(entries.data()), header.count * sizeof(GfxTraceEntry));
+    if (!in.good()) {
+        entries.clear();
+        return false;
+    }
+
+    return true;
+}
+
+std::string GfxTraceRecorder::FormatEntry(const GfxTraceEntry& entry) {
+    const char* name = nullptr;
+    if (entry.ucode < ucode_max) {
+        name = GfxGetOpcodeName(entry.opcode, (UcodeHandlers)entry.ucode);
+    }
+
+    return fmt::format("{:>16} {:>3} {:02X} {:<24} {:016X} {:016X}", entry.timestamp, entry.depth,
+                       (uint8_t)entry.opcode, name != nullptr ? name : "UNKNOWN", entry.w0, entry.w1);
+}
+
+} // namespace Fast
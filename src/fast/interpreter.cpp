@@ -15,6 +15,7 @@
 #include <vector>
 #include <list>
 #include <stack>
+#include <utility>
 #include "fast/resource/type/Light.h"
 
 #ifndef _LANGUAGE_C
@@ -43,8 +44,6 @@
 #include <windows.h>
 #endif
 
-std::stack<std::string> currentDir;
-
 #define SEG_ADDR(seg, addr) (addr | (seg << 24) | 1)
 #define SUPPORT_CHECK(x) assert(x)
 
@@ -67,11 +66,11 @@ std::stack<std::string> currentDir;
     ((mFbActive ? activeFb->second.applied_height : dims.height) / (2.0f * HALF_SCREEN_HEIGHT(activeFb)))
 
 #define TEXTURE_CACHE_MAX_SIZE 1024
+#define S2DEX_BG_CACHE_MAX_SIZE 64
+#define MASKED_TEXTURE_LOOKUP_MAX_SIZE 4096
 
 namespace Fast {
 
-static UcodeHandlers ucode_handler_index = ucode_f3dex2;
-
 const static uint32_t f3dex2AttrHandler[] = {
     F3DEX2_G_MTX_PROJECTION, F3DEX2_G_MTX_LOAD,  F3DEX2_G_MTX_PUSH,  F3DEX_G_MTX_NOPUSH,
     F3DEX2_G_CULL_FRONT,     F3DEX2_G_CULL_BACK, F3DEX2_G_CULL_BOTH,
@@ -90,8 +89,8 @@ static constexpr std::array ucode_attr_handlers = {
     &f3dex2AttrHandler, // ucode_s2dex
 };
 
-static uint32_t get_attr(Attribute attr) {
-    const auto ucode_map = ucode_attr_handlers[ucode_handler_index];
+uint32_t Interpreter::GetAttr(Attribute attr) const {
+    const auto ucode_map = ucode_attr_handlers[mUcodeHandlerIndex];
     // assert(ucode_map->contains(attr) && "Attribute not found in the current ucode handler");
     return (*ucode_map)[attr];
 }
@@ -122,10 +121,29 @@ Interpreter::~Interpreter() {
     delete[] mBufVbo;
 }
 
-static std::weak_ptr<Interpreter> mInstance;
+// Interpreter bound to this thread by an Interpreter::ThreadScope. Run binds itself for the whole frame and keeps a
+// strong reference meanwhile, other owners keep theirs alive while their scope exists.
+static thread_local Interpreter* sThreadInstance = nullptr;
+// Instance owned by the window, used on threads that have no interpreter bound
+static std::weak_ptr<Interpreter> sDefaultInstance;
+
 // Set a cached pointer to the instance so we don't need to go through the window every time
 void GfxSetInstance(std::shared_ptr<Interpreter> gfx) {
-    mInstance = gfx;
+    sDefaultInstance = gfx;
+}
+
+static Interpreter* GetActiveInstance() {
+    if (sThreadInstance != nullptr) {
+        return sThreadInstance;
+    }
+    return sDefaultInstance.lock().get();
+}
+
+Interpreter::ThreadScope::ThreadScope(Interpreter* gfx) : mPrevious(std::exchange(sThreadInstance, gfx)) {
+}
+
+Interpreter::ThreadScope::~ThreadScope() {
+    sThreadInstance = mPrevious;
 }
 
 // N64 prim_depth is 15-bit (0 near, 0x7FFF far).
@@ -447,6 +465,7 @@ void Interpreter::TextureCacheClear() {
     }
     mTextureCache.map.clear();
     mTextureCache.lru.clear();
+    mS2dexBgImages.clear();
     // Pre-allocate buckets so the map never rehashes during normal operation.
     // Rehashing invalidates all iterators, including those stored in LRU entries.
     mTextureCache.map.reserve(TEXTURE_CACHE_MAX_SIZE);
@@ -458,7 +477,7 @@ void Interpreter::ShaderCacheClear() {
     mRapi->ClearShaderCache();
 }
 
-bool Interpreter::TextureCacheLookup(int i, const TextureCacheKey& key) {
+bool Interpreter::TextureCacheLookup(int i, const TextureCacheKey& key, std::shared_ptr<Fast::Texture> resource) {
     TextureCacheMap::iterator it = mTextureCache.map.find(key);
     TextureCacheNode** n = &mRenderingState.mTextures[i];
 
@@ -493,6 +512,7 @@ bool Interpreter::TextureCacheLookup(int i, const TextureCacheKey& key) {
     it = mTextureCache.map.insert(std::make_pair(key, TextureCacheValue())).first;
     TextureCacheNode* node = &*it;
     node->second.texture_id = texture_id;
+    node->second.resource = std::move(resource);
     node->second.lru_location = mTextureCache.lru.insert(mTextureCache.lru.end(), { it });
 
     mRapi->SelectTexture(i, texture_id);
@@ -510,6 +530,7 @@ std::string_view Interpreter::GetBaseTexturePath(std::string_view path) {
 }
 
 void Interpreter::TextureCacheDelete(const uint8_t* origAddr) {
+    mS2dexBgImages.erase(origAddr);
     while (mTextureCache.map.bucket_count() > 0) {
         TextureCacheKey key = { origAddr, { 0 }, 0, 0, 0 }; // bucket index only depends on the address
         size_t bucket = mTextureCache.map.bucket(key);
@@ -549,7 +570,7 @@ void Interpreter::ImportTextureRgba16(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -617,7 +638,7 @@ void Interpreter::ImportTextureRgba32(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -676,7 +697,7 @@ void Interpreter::ImportTextureIA4(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -721,7 +742,7 @@ void Interpreter::ImportTextureIA8(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -763,7 +784,7 @@ void Interpreter::ImportTextureIA16(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -813,7 +834,7 @@ void Interpreter::ImportTextureI4(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -865,7 +886,7 @@ void Interpreter::ImportTextureI8(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -907,7 +928,7 @@ void Interpreter::ImportTextureCi4(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -986,7 +1007,7 @@ void Interpreter::ImportTextureCi8(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -1055,7 +1076,7 @@ void Interpreter::ImportTextureImg(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -1072,7 +1093,7 @@ void Interpreter::ImportTextureRaw(int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* addr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr;
 
     if (addr == nullptr) {
@@ -1159,7 +1180,7 @@ void Interpreter::ImportTexture(int i, int tile, bool importReplacement) {
     const RawTexMetadata* metadata = &mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata;
     const uint8_t* origAddr =
         importReplacement && (metadata->resource != nullptr)
-            ? mMaskedTextures.find(GetBaseTexturePath(metadata->resource->GetInitData()->Path))->second.replacementData
+            ? FindMaskedTexture(metadata->resource)->replacementData
             : mRdp->loaded_texture[tmemIdex].addr;
 
     // Check if this texture address is a registered GPU framebuffer mirror.
@@ -1212,7 +1233,7 @@ void Interpreter::ImportTexture(int i, int tile, bool importReplacement) {
         key = { origAddr, {}, fmt, siz, paletteIndex, origSizeBytes };
     }
 
-    if (TextureCacheLookup(i, key)) {
+    if (TextureCacheLookup(i, key, mRdp->loaded_texture[tmemIdex].raw_tex_metadata.resource)) {
         return;
     }
 
@@ -1299,12 +1320,12 @@ void Interpreter::ImportTextureMask(int i, int tile) {
         return;
     }
 
-    auto maskIter = mMaskedTextures.find(GetBaseTexturePath(metadata.resource->GetInitData()->Path));
-    if (maskIter == mMaskedTextures.end()) {
+    const MaskedTextureEntry* maskEntry = FindMaskedTexture(metadata.resource);
+    if (maskEntry == nullptr) {
         return;
     }
 
-    const uint8_t* orig_addr = maskIter->second.mask;
+    const uint8_t* orig_addr = maskEntry->mask;
 
     if (orig_addr == nullptr) {
         return;
@@ -1312,7 +1333,7 @@ void Interpreter::ImportTextureMask(int i, int tile) {
 
     TextureCacheKey key = { orig_addr, {}, 0, 0, 0, 0 };
 
-    if (TextureCacheLookup(i, key)) {
+    if (TextureCacheLookup(i, key, nullptr)) {
         return;
     }
 
@@ -1411,9 +1432,9 @@ void Interpreter::GfxSpMatrix(uint8_t parameters, const int32_t* addr) {
 #endif
     }
 
-    const int8_t mtx_projection = get_attr(MTX_PROJECTION);
-    const int8_t mtx_load = get_attr(MTX_LOAD);
-    const int8_t mtx_push = get_attr(MTX_PUSH);
+    const int8_t mtx_projection = GetAttr(MTX_PROJECTION);
+    const int8_t mtx_load = GetAttr(MTX_LOAD);
+    const int8_t mtx_push = GetAttr(MTX_PUSH);
 
     if (parameters & mtx_projection) {
         if (parameters & mtx_load) {
@@ -1690,9 +1711,9 @@ void Interpreter::GfxSpTri1(uint8_t vtx1_idx, uint8_t vtx2_idx, uint8_t vtx3_idx
         return;
     }
 
-    const uint32_t cull_both = get_attr(CULL_BOTH);
-    const uint32_t cull_front = get_attr(CULL_FRONT);
-    const uint32_t cull_back = get_attr(CULL_BACK);
+    const uint32_t cull_both = GetAttr(CULL_BOTH);
+    const uint32_t cull_front = GetAttr(CULL_FRONT);
+    const uint32_t cull_back = GetAttr(CULL_BACK);
 
     if ((mRsp->geometry_mode & cull_both) != 0) {
         float dx1 = v1->x / (v1->w) - v2->x / (v2->w);
@@ -2504,15 +2525,10 @@ void Interpreter::GfxDpLoadBlock(uint8_t tile, uint32_t uls, uint32_t ult, uint3
     // orig_size_bytes,
     //         mRdp->texture_to_load.siz, lrs);
 
-    const std::string_view texPath =
-        mRdp->texture_to_load.raw_tex_metadata.resource != nullptr
-            ? GetBaseTexturePath(mRdp->texture_to_load.raw_tex_metadata.resource->GetInitData()->Path)
-            : std::string_view{};
-    auto maskedTextureIter = mMaskedTextures.find(texPath);
-    if (maskedTextureIter != mMaskedTextures.end()) {
+    const MaskedTextureEntry* maskEntry = FindMaskedTexture(mRdp->texture_to_load.raw_tex_metadata.resource);
+    if (maskEntry != nullptr) {
         mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].masked = true;
-        mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].blended =
-            maskedTextureIter->second.replacementData != nullptr;
+        mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].blended = maskEntry->replacementData != nullptr;
     } else {
         mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].masked = false;
         mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].blended = false;
@@ -2574,15 +2590,10 @@ void Interpreter::GfxDpLoadTile(uint8_t tile, uint32_t uls, uint32_t ult, uint32
     mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].raw_tex_metadata = mRdp->texture_to_load.raw_tex_metadata;
     mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].addr = mRdp->texture_to_load.addr + start_offset_bytes;
 
-    const std::string_view texPath =
-        mRdp->texture_to_load.raw_tex_metadata.resource != nullptr
-            ? GetBaseTexturePath(mRdp->texture_to_load.raw_tex_metadata.resource->GetInitData()->Path)
-            : std::string_view{};
-    auto maskedTextureIter = mMaskedTextures.find(texPath);
-    if (maskedTextureIter != mMaskedTextures.end()) {
+    const MaskedTextureEntry* maskEntry = FindMaskedTexture(mRdp->texture_to_load.raw_tex_metadata.resource);
+    if (maskEntry != nullptr) {
         mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].masked = true;
-        mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].blended =
-            maskedTextureIter->second.replacementData != nullptr;
+        mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].blended = maskEntry->replacementData != nullptr;
     } else {
         mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].masked = false;
         mRdp->loaded_texture[mRdp->texture_tile[tile].tmem_index].blended = false;
@@ -2972,6 +2983,51 @@ void Interpreter::GfxDpSetOtherMode(uint32_t h, uint32_t l) {
     mRdp->other_mode_l = l;
 }
 
+const S2dexBgImage* Interpreter::S2dexBgImageLookup(const F3DuObjBg* bg) {
+    const void* imagePtr = bg->b.imagePtr;
+    const bool altAssets = Ship::Context::GetInstance()->GetResourceManager()->IsAltAssetsEnabled();
+    const bool isPath = (bool)gfx_check_image_signature((const char*)imagePtr);
+
+    // Toggling alt assets changes what a path resolves to, and the game may have put another path or raw image data
+    // at the same address
+    auto it = mS2dexBgImages.find(imagePtr);
+    if (it != mS2dexBgImages.end() && it->second.altAssets == altAssets && it->second.path.empty() == !isPath) {
+        if (!isPath) {
+            return &it->second;
+        }
+        if (it->second.path == (const char*)imagePtr && !it->second.rawTexMetadata.resource->IsDirty()) {
+            return &it->second;
+        }
+    }
+
+    S2dexBgImage image = {};
+    image.data = (uintptr_t)imagePtr;
+    image.altAssets = altAssets;
+
+    if (isPath) {
+        image.path = (const char*)imagePtr;
+        std::shared_ptr<Fast::Texture> tex = std::static_pointer_cast<Fast::Texture>(
+            Ship::Context::GetInstance()->GetResourceManager()->LoadResourceProcess((const char*)imagePtr));
+        if (tex == nullptr) {
+            SPDLOG_ERROR("Failed to load S2DEX background {}", (const char*)imagePtr);
+            return nullptr;
+        }
+        image.texFlags = tex->Flags;
+        image.rawTexMetadata.width = tex->Width;
+        image.rawTexMetadata.height = tex->Height;
+        image.rawTexMetadata.h_byte_scale = tex->HByteScale;
+        image.rawTexMetadata.v_pixel_scale = tex->VPixelScale;
+        image.rawTexMetadata.type = tex->Type;
+        image.rawTexMetadata.resource = tex;
+        image.data = (uintptr_t) reinterpret_cast<char*>(tex->ImageData);
+    }
+
+    if (mS2dexBgImages.size() >= S2DEX_BG_CACHE_MAX_SIZE) {
+        mS2dexBgImages.clear();
+    }
+    return &(mS2dexBgImages[imagePtr] = std::move(image));
+}
+
 void Interpreter::Gfxs2dexBgCopy(F3DuObjBg* bg) {
     /*
     bg->b.imageX = 0;
@@ -2988,22 +3044,9 @@ void Interpreter::Gfxs2dexBgCopy(F3DuObjBg* bg) {
     bg->b.imageFlip = 0;
     */
 
-    uintptr_t data = (uintptr_t)bg->b.imagePtr;
-
-    uint32_t texFlags = 0;
-    RawTexMetadata rawTexMetadata = {};
-
-    if ((bool)gfx_check_image_signature((char*)data)) {
-        std::shared_ptr<Fast::Texture> tex = std::static_pointer_cast<Fast::Texture>(
-            Ship::Context::GetInstance()->GetResourceManager()->LoadResourceProcess((char*)data));
-        texFlags = tex->Flags;
-        rawTexMetadata.width = tex->Width;
-        rawTexMetadata.height = tex->Height;
-        rawTexMetadata.h_byte_scale = tex->HByteScale;
-        rawTexMetadata.v_pixel_scale = tex->VPixelScale;
-        rawTexMetadata.type = tex->Type;
-        rawTexMetadata.resource = tex;
-        data = (uintptr_t) reinterpret_cast<char*>(tex->ImageData);
+    const S2dexBgImage* image = S2dexBgImageLookup(bg);
+    if (image == nullptr) {
+        return;
     }
 
     s16 dsdx = 4 << 10;
@@ -3015,7 +3058,8 @@ void Interpreter::Gfxs2dexBgCopy(F3DuObjBg* bg) {
     }
 
     SUPPORT_CHECK(bg->b.imageSiz == G_IM_SIZ_16b);
-    GfxDpSetTextureImage(G_IM_FMT_RGBA, G_IM_SIZ_16b, 0, nullptr, texFlags, rawTexMetadata, (void*)data);
+    GfxDpSetTextureImage(G_IM_FMT_RGBA, G_IM_SIZ_16b, 0, nullptr, image->texFlags, image->rawTexMetadata,
+                         (void*)image->data);
     GfxDpSetTile(G_IM_FMT_RGBA, G_IM_SIZ_16b, 0, 0, G_TX_LOADTILE, 0, 0, 0, 0, 0, 0, 0);
     GfxDpLoadBlock(G_TX_LOADTILE, 0, 0, (bg->b.imageW * bg->b.imageH >> 4) - 1, 0);
     GfxDpSetTile(bg->b.imageFmt, G_IM_SIZ_16b, bg->b.imageW >> 4, 0, G_TX_RENDERTILE, bg->b.imagePal, 0, 0, 0, 0, 0, 0);
@@ -3025,29 +3069,18 @@ void Interpreter::Gfxs2dexBgCopy(F3DuObjBg* bg) {
 }
 
 void Interpreter::Gfxs2dexBg1cyc(F3DuObjBg* bg) {
-    uintptr_t data = (uintptr_t)bg->b.imagePtr;
-
-    uint32_t texFlags = 0;
-    RawTexMetadata rawTexMetadata = {};
+    const S2dexBgImage* image = S2dexBgImageLookup(bg);
+    if (image == nullptr) {
+        return;
+    }
 
-    if ((bool)gfx_check_image_signature((char*)data)) {
-        std::shared_ptr<Fast::Texture> tex = std::static_pointer_cast<Fast::Texture>(
-            Ship::Context::GetInstance()->GetResourceManager()->LoadResourceProcess((char*)data));
-        texFlags = tex->Flags;
-        rawTexMetadata.width = tex->Width;
-        rawTexMetadata.height = tex->Height;
-        rawTexMetadata.h_byte_scale = tex->HByteScale;
-        rawTexMetadata.v_pixel_scale = tex->VPixelScale;
-        rawTexMetadata.type = tex->Type;
-        rawTexMetadata.resource = tex;
-        data = (uintptr_t) reinterpret_cast<char*>(tex->ImageData);
-    }
-
-    // TODO: Implement bg scaling correctly
     s16 uls = bg->b.imageX >> 2;
     s16 lrs = bg->b.imageW >> 2;
 
-    s16 dsdxRect = 1 << 10;
+    // BG_1CYC takes a uObjScaleBg, scaleW/scaleH are texels per screen pixel in u5.10. The whole image is loaded as
+    // one block and drawn as a single rectangle, so the texture cache holds it as one decoded texture.
+    s16 dsdxRect = (s16)std::clamp<int32_t>(bg->s.scaleW != 0 ? bg->s.scaleW : 1 << 10, 1, INT16_MAX);
+    s16 dtdyRect = (s16)std::clamp<int32_t>(bg->s.scaleH != 0 ? bg->s.scaleH : 1 << 10, 1, INT16_MAX);
     s16 ulsRect = bg->b.imageX << 3;
     // Flip flag only flips horizontally
     if (bg->b.imageFlip == G_BG_FLAG_FLIPS) {
@@ -3055,16 +3088,18 @@ void Interpreter::Gfxs2dexBg1cyc(F3DuObjBg* bg) {
         ulsRect = (bg->b.imageW - bg->b.imageX) << 3;
     }
 
-    GfxDpSetTextureImage(bg->b.imageFmt, bg->b.imageSiz, bg->b.imageW >> 2, nullptr, texFlags, rawTexMetadata,
-                         (void*)data);
+    GfxDpSetTextureImage(bg->b.imageFmt, bg->b.imageSiz, bg->b.imageW >> 2, nullptr, image->texFlags,
+                         image->rawTexMetadata, (void*)image->data);
     GfxDpSetTile(bg->b.imageFmt, bg->b.imageSiz, 0, 0, G_TX_LOADTILE, 0, 0, 0, 0, 0, 0, 0);
     GfxDpLoadBlock(G_TX_LOADTILE, 0, 0, (bg->b.imageW * bg->b.imageH >> 4) - 1, 0);
     GfxDpSetTile(bg->b.imageFmt, bg->b.imageSiz, (((lrs - uls) * bg->b.imageSiz) + 7) >> 3, 0, G_TX_RENDERTILE,
                  bg->b.imagePal, 0, 0, 0, 0, 0, 0);
-    GfxDpSetTileSize(G_TX_RENDERTILE, 0, 0, bg->b.imageW, bg->b.imageH);
+    // Tile sizes are inclusive
+    GfxDpSetTileSize(G_TX_RENDERTILE, 0, 0, bg->b.imageW - 4, bg->b.imageH - 4);
 
-    GfxDpTextureRectangle(bg->b.frameX, bg->b.frameY, bg->b.frameW, bg->b.frameH, G_TX_RENDERTILE, ulsRect,
-                          bg->b.imageY << 3, dsdxRect, 1 << 10, false);
+    // frameW/frameH are the size on screen, not the lower right corner
+    GfxDpTextureRectangle(bg->b.frameX, bg->b.frameY, bg->b.frameX + bg->b.frameW, bg->b.frameY + bg->b.frameH,
+                          G_TX_RENDERTILE, ulsRect, bg->b.imageY << 3, dsdxRect, dtdyRect, false);
 }
 
 void Interpreter::Gfxs2dexRecyCopy(F3DuObjSprite* spr) {
@@ -3111,22 +3146,34 @@ void* Interpreter::SegAddr(uintptr_t w1) {
 #define C0(pos, width) ((cmd->words.w0 >> (pos)) & ((1U << width) - 1))
 #define C1(pos, width) ((cmd->words.w1 >> (pos)) & ((1U << width) - 1))
 
-void GfxExecStack::start(F3DGfx* dlist) {
-    while (!cmd_stack.empty())
-        cmd_stack.pop();
-    gfx_path.clear();
-    cmd_stack.push(dlist);
+void GfxExecStack::start(F3DGfx* dlist, bool recordPath) {
+    cmd_stack[0] = dlist;
+    cmd_stack_size = 1;
+    gfx_path_size = 0;
+    record_path = recordPath;
     disp_stack.clear();
 }
 
 void GfxExecStack::stop() {
-    while (!cmd_stack.empty())
-        cmd_stack.pop();
-    gfx_path.clear();
+    cmd_stack_size = 0;
+    gfx_path_size = 0;
+}
+
+bool GfxExecStack::empty() const {
+    return cmd_stack_size == 0;
+}
+
+size_t GfxExecStack::depth() const {
+    return cmd_stack_size;
 }
 
 F3DGfx*& GfxExecStack::currCmd() {
-    return cmd_stack.top();
+    return cmd_stack[cmd_stack_size - 1];
+}
+
+std::span<const F3DGfx* const> GfxExecStack::currPath() {
+    gfx_path[gfx_path_size] = currCmd();
+    return { gfx_path, gfx_path_size + 1 };
 }
 
 void GfxExecStack::openDisp(const char* file, int line) {
@@ -3140,31 +3187,47 @@ const std::vector<GfxExecStack::CodeDisp>& GfxExecStack::getDisp() const {
 }
 
 void GfxExecStack::branch(F3DGfx* caller) {
-    F3DGfx* old = cmd_stack.top();
-    cmd_stack.pop();
-    cmd_stack.push(nullptr);
-    cmd_stack.push(old);
+    // The branch target already replaced the current entry. A marker is only needed to keep the call path in sync.
+    if (!record_path) {
+        return;
+    }
 
-    gfx_path.push_back(caller);
+    if (cmd_stack_size == GFX_EXEC_STACK_MAX_DEPTH) {
+        SPDLOG_ERROR("Display list stack overflow, branch is not recorded in the debugger path");
+        return;
+    }
+
+    F3DGfx* old = currCmd();
+    currCmd() = nullptr;
+    cmd_stack[cmd_stack_size++] = old;
+    gfx_path[gfx_path_size++] = caller;
 }
 
-void GfxExecStack::call(F3DGfx* caller, F3DGfx* callee) {
-    cmd_stack.push(callee);
-    gfx_path.push_back(caller);
+bool GfxExecStack::call(F3DGfx* caller, F3DGfx* callee) {
+    if (cmd_stack_size == GFX_EXEC_STACK_MAX_DEPTH) {
+        SPDLOG_ERROR("Display list stack overflow, skipping call to {}", (void*)callee);
+        return false;
+    }
+
+    cmd_stack[cmd_stack_size++] = callee;
+    if (record_path) {
+        gfx_path[gfx_path_size++] = caller;
+    }
+    return true;
 }
 
 F3DGfx* GfxExecStack::ret() {
-    F3DGfx* cmd = cmd_stack.top();
+    F3DGfx* cmd = currCmd();
 
-    cmd_stack.pop();
-    if (!gfx_path.empty()) {
-        gfx_path.pop_back();
+    cmd_stack_size--;
+    if (gfx_path_size > 0) {
+        gfx_path_size--;
     }
 
-    while (cmd_stack.size() > 0 && cmd_stack.top() == nullptr) {
-        cmd_stack.pop();
-        if (!gfx_path.empty()) {
-            gfx_path.pop_back();
+    while (cmd_stack_size > 0 && currCmd() == nullptr) {
+        cmd_stack_size--;
+        if (gfx_path_size > 0) {
+            gfx_path_size--;
         }
     }
     return cmd;
@@ -3174,33 +3237,30 @@ void gfx_set_framebuffer(int fb, float noise_scale);
 void gfx_reset_framebuffer();
 void gfx_copy_framebuffer(int fb_dst_id, int fb_src_id, bool copyOnce, bool* hasCopiedPtr);
 
-// The main type of the handler function. These function will take a pointer to a pointer to a Gfx. It needs to be a
-// double pointer because we sometimes need to increment and decrement the underlying pointer Returns false if the
-// current opcode should be incremented after the handler ends.
-typedef bool (*GfxOpcodeHandlerFunc)(F3DGfx** gfx);
+// The main type of the handler function. These function will take the interpreter executing the display list and a
+// pointer to a pointer to a Gfx. It needs to be a double pointer because we sometimes need to increment and decrement
+// the underlying pointer Returns false if the current opcode should be incremented after the handler ends.
+typedef bool (*GfxOpcodeHandlerFunc)(Interpreter* gfx, F3DGfx** cmd);
 
-bool gfx_load_ucode_handler_f3dex2(F3DGfx** cmd) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_load_ucode_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd) {
     gfx->mRsp->fog_mul = 0;
     gfx->mRsp->fog_offset = 0;
     return false;
 }
 
-bool gfx_cull_dl_handler_f3dex2(F3DGfx** cmd) {
+bool gfx_cull_dl_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd) {
     // TODO:
     return false;
 }
 
-bool gfx_marker_handler_otr(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_marker_handler_otr(Interpreter* gfx, F3DGfx** cmd0) {
     (*cmd0)++;
     F3DGfx* cmd = (*cmd0);
     gfx->mMarkerOn = true;
     return false;
 }
 
-bool gfx_invalidate_tex_cache_handler_f3dex2(F3DGfx** cmd) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_invalidate_tex_cache_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd) {
     const uintptr_t texAddr = (*cmd)->words.w1;
 
     if (texAddr == 0) {
@@ -3211,25 +3271,24 @@ bool gfx_invalidate_tex_cache_handler_f3dex2(F3DGfx** cmd) {
     return false;
 }
 
-bool gfx_noop_handler_f3dex2(F3DGfx** cmd0) {
+bool gfx_noop_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     const char* filename = (const char*)(cmd)->words.w1;
     uint32_t p = C0(16, 8);
     uint32_t l = C0(0, 16);
     if (p == 7) {
-        g_exec_stack.openDisp(filename, l);
+        gfx->mExecStack.openDisp(filename, l);
     } else if (p == 8) {
-        if (g_exec_stack.disp_stack.size() == 0) {
+        if (gfx->mExecStack.disp_stack.size() == 0) {
             SPDLOG_WARN("CLOSE_DISPS without matching open {}:{}", p, l);
         } else {
-            g_exec_stack.closeDisp();
+            gfx->mExecStack.closeDisp();
         }
     }
     return false;
 }
 
-bool gfx_mtx_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_mtx_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     uintptr_t mtxAddr = cmd->words.w1;
 
@@ -3237,8 +3296,7 @@ bool gfx_mtx_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 // Seems to be the same for all other non F3DEX2 microcodes...
-bool gfx_mtx_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_mtx_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     uintptr_t mtxAddr = cmd->words.w1;
 
@@ -3246,8 +3304,7 @@ bool gfx_mtx_handler_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_mtx_otr_filepath_handler_custom_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_mtx_otr_filepath_handler_custom_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     const char* fileName = (const char*)cmd->words.w1;
     const int32_t* mtx = (const int32_t*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(
@@ -3260,8 +3317,7 @@ bool gfx_mtx_otr_filepath_handler_custom_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_mtx_otr_filepath_handler_custom_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_mtx_otr_filepath_handler_custom_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     const char* fileName = (const char*)cmd->words.w1;
     const int32_t* mtx = (const int32_t*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(
@@ -3274,15 +3330,15 @@ bool gfx_mtx_otr_filepath_handler_custom_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_mtx_otr_filepath_handler_custom(F3DGfx** cmd0) {
-    if (ucode_handler_index == ucode_f3dex2) {
-        return gfx_mtx_otr_filepath_handler_custom_f3dex2(cmd0);
+bool gfx_mtx_otr_filepath_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
+    if (gfx->mUcodeHandlerIndex == ucode_f3dex2) {
+        return gfx_mtx_otr_filepath_handler_custom_f3dex2(gfx, cmd0);
     } else {
-        return gfx_mtx_otr_filepath_handler_custom_f3d(cmd0);
+        return gfx_mtx_otr_filepath_handler_custom_f3d(gfx, cmd0);
     }
 }
 
-bool gfx_mtx_otr_handler_custom_f3dex2(F3DGfx** cmd0) {
+bool gfx_mtx_otr_handler_custom_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     (*cmd0)++;
     F3DGfx* cmd = *cmd0;
 
@@ -3291,7 +3347,6 @@ bool gfx_mtx_otr_handler_custom_f3dex2(F3DGfx** cmd0) {
         (const int32_t*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(hash);
 
     if (mtx != NULL) {
-        Interpreter* gfx = mInstance.lock().get();
         cmd--;
         gfx->GfxSpMatrix(C0(0, 8) ^ F3DEX2_G_MTX_PUSH, mtx);
         cmd++;
@@ -3300,8 +3355,7 @@ bool gfx_mtx_otr_handler_custom_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_mtx_otr_handler_custom_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_mtx_otr_handler_custom_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     (*cmd0)++;
     F3DGfx* cmd = *cmd0;
 
@@ -3316,16 +3370,15 @@ bool gfx_mtx_otr_handler_custom_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_mtx_otr_handler_custom(F3DGfx** cmd0) {
-    if (ucode_handler_index == ucode_f3dex2) {
-        return gfx_mtx_otr_handler_custom_f3dex2(cmd0);
+bool gfx_mtx_otr_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
+    if (gfx->mUcodeHandlerIndex == ucode_f3dex2) {
+        return gfx_mtx_otr_handler_custom_f3dex2(gfx, cmd0);
     } else {
-        return gfx_mtx_otr_handler_custom_f3d(cmd0);
+        return gfx_mtx_otr_handler_custom_f3d(gfx, cmd0);
     }
 }
 
-bool gfx_pop_mtx_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_pop_mtx_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpPopMatrix((uint32_t)(cmd->words.w1 / 64));
@@ -3333,8 +3386,7 @@ bool gfx_pop_mtx_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_pop_mtx_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_pop_mtx_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpPopMatrix(1);
@@ -3342,8 +3394,7 @@ bool gfx_pop_mtx_handler_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_movemem_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_movemem_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpMovememF3dex2(C0(0, 8), C0(8, 8) * 8, gfx->SegAddr(cmd->words.w1));
@@ -3351,8 +3402,7 @@ bool gfx_movemem_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_movemem_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_movemem_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpMovememF3d(C0(16, 8), 0, gfx->SegAddr(cmd->words.w1));
@@ -3360,8 +3410,7 @@ bool gfx_movemem_handler_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_movemem_handler_otr(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_movemem_handler_otr(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     const uint8_t index = C1(24, 8);
@@ -3372,7 +3421,7 @@ bool gfx_movemem_handler_otr(F3DGfx** cmd0) {
 
     const uint64_t hash = ((uint64_t)(*cmd0)->words.w0 << 32) + (*cmd0)->words.w1;
 
-    if (ucode_handler_index == ucode_f3dex2) {
+    if (gfx->mUcodeHandlerIndex == ucode_f3dex2) {
         gfx->GfxSpMovememF3dex2(index, offset,
                                 Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(hash));
     } else {
@@ -3383,8 +3432,7 @@ bool gfx_movemem_handler_otr(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_push_shader(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_push_shader(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     const char* path = (const char*)gfx->SegAddr(cmd->words.w1);
 
@@ -3413,8 +3461,7 @@ bool gfx_push_shader(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_pop_shader(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_pop_shader(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->mShaderStack.pop();
@@ -3423,7 +3470,7 @@ bool gfx_pop_shader(F3DGfx** cmd0) {
 }
 
 const char* gfx_get_shader(int16_t id) {
-    Interpreter* gfx = mInstance.lock().get();
+    Interpreter* gfx = GetActiveInstance();
 
     for (const std::pair<size_t, const char*>& shader : gfx->mShaders) {
         if (shader.first == id) {
@@ -3434,8 +3481,7 @@ const char* gfx_get_shader(int16_t id) {
     return nullptr; // Use no shader
 }
 
-bool gfx_moveword_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_moveword_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpMovewordF3dex2(C0(16, 8), C0(0, 16), cmd->words.w1);
@@ -3443,8 +3489,7 @@ bool gfx_moveword_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_moveword_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_moveword_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpMovewordF3d(C0(0, 8), C0(8, 16), cmd->words.w1);
@@ -3452,8 +3497,7 @@ bool gfx_moveword_handler_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_texture_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_texture_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTexture(C1(16, 16), C1(0, 16), C0(11, 3), C0(8, 3), C0(1, 7));
@@ -3462,8 +3506,7 @@ bool gfx_texture_handler_f3dex2(F3DGfx** cmd0) {
 }
 
 // Seems to be the same for all other non F3DEX2 microcodes...
-bool gfx_texture_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_texture_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTexture(C1(16, 16), C1(0, 16), C0(11, 3), C0(8, 3), C0(0, 8));
@@ -3472,8 +3515,7 @@ bool gfx_texture_handler_f3d(F3DGfx** cmd0) {
 }
 
 // Almost all versions of the microcode have their own version of this opcode
-bool gfx_vtx_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_vtx_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpVertex(C0(12, 8), C0(1, 7) - C0(12, 8), (const F3DVtx*)gfx->SegAddr(cmd->words.w1));
@@ -3481,16 +3523,14 @@ bool gfx_vtx_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_vtx_handler_f3dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_vtx_handler_f3dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     gfx->GfxSpVertex(C0(10, 6), C0(17, 7), (const F3DVtx*)gfx->SegAddr(cmd->words.w1));
 
     return false;
 }
 
-bool gfx_vtx_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_vtx_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpVertex((C0(0, 16)) / sizeof(F3DVtx), C0(16, 4), (const F3DVtx*)gfx->SegAddr(cmd->words.w1));
@@ -3498,8 +3538,7 @@ bool gfx_vtx_handler_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_vtx_hash_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_vtx_hash_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     // Offset added to the start of the vertices
     const uintptr_t offset = (*cmd0)->words.w1;
     // This is a two-part display list command, so increment the instruction pointer so we can get the CRC64
@@ -3533,8 +3572,7 @@ bool gfx_vtx_hash_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_vtx_otr_filepath_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_vtx_otr_filepath_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     char* fileName = (char*)cmd->words.w1;
     (*cmd0)++;
@@ -3550,18 +3588,18 @@ bool gfx_vtx_otr_filepath_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_dl_otr_filepath_handler_custom(F3DGfx** cmd0) {
+bool gfx_dl_otr_filepath_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     char* fileName = (char*)cmd->words.w1;
     F3DGfx* nDL =
         (F3DGfx*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer((const char*)fileName);
 
     if (C0(16, 1) == 0 && nDL != nullptr) {
-        g_exec_stack.call(*cmd0, nDL);
+        gfx->mExecStack.call(*cmd0, nDL);
     } else {
         if (nDL != nullptr) {
             (*cmd0) = nDL;
-            g_exec_stack.branch(cmd);
+            gfx->mExecStack.branch(cmd);
             return true; // shortcut cmd increment
         } else {
             assert(0 && "???");
@@ -3574,32 +3612,30 @@ bool gfx_dl_otr_filepath_handler_custom(F3DGfx** cmd0) {
 }
 
 // The original F3D microcode doesn't seem to have this opcode. Glide handles it as part of moveword
-bool gfx_modify_vtx_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_modify_vtx_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     gfx->GfxSpModifyVertex(C0(1, 15), C0(16, 8), (uint32_t)cmd->words.w1);
     return false;
 }
 
 // F3D, F3DEX, and F3DEX2 do the same thing but F3DEX2 has its own opcode number
-bool gfx_dl_handler_common(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_dl_handler_common(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     F3DGfx* subGFX = (F3DGfx*)gfx->SegAddr(cmd->words.w1);
     if (C0(16, 1) == 0) {
         // Push return address
         if (subGFX != nullptr) {
-            g_exec_stack.call(*cmd0, subGFX);
+            gfx->mExecStack.call(*cmd0, subGFX);
         }
     } else {
         (*cmd0) = subGFX;
-        g_exec_stack.branch(cmd);
+        gfx->mExecStack.branch(cmd);
         return true; // shortcut cmd increment
     }
     return false;
 }
 
-bool gfx_dl_otr_hash_handler_custom(F3DGfx** cmd0) {
+bool gfx_dl_otr_hash_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     if (C0(16, 1) == 0) {
         // Push return address
@@ -3607,24 +3643,22 @@ bool gfx_dl_otr_hash_handler_custom(F3DGfx** cmd0) {
 
         uint64_t hash = ((uint64_t)(*cmd0)->words.w0 << 32) + (*cmd0)->words.w1;
 
-        F3DGfx* gfx = (F3DGfx*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(hash);
+        F3DGfx* nDL = (F3DGfx*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(hash);
 
-        if (gfx != 0) {
-            g_exec_stack.call(cmd, gfx);
+        if (nDL != 0) {
+            gfx->mExecStack.call(cmd, nDL);
         }
     } else {
-        Interpreter* gfx = mInstance.lock().get();
         assert(0 && "????");
         (*cmd0) = (F3DGfx*)gfx->SegAddr((*cmd0)->words.w1);
         return true;
     }
     return false;
 }
-bool gfx_dl_index_handler(F3DGfx** cmd0) {
+bool gfx_dl_index_handler(Interpreter* gfx, F3DGfx** cmd0) {
     // Compute seg addr by converting an index value to a offset value
     // handling 32 vs 64 bit size differences for Gfx
     // adding 1 to trigger the segaddr flow
-    Interpreter* gfx = mInstance.lock().get();
     F3DGfx* cmd = (*cmd0);
     uint8_t segNum = (uint8_t)(cmd->words.w1 >> 24);
     uint32_t index = (uint32_t)(cmd->words.w1 & 0x00FFFFFF);
@@ -3634,26 +3668,25 @@ bool gfx_dl_index_handler(F3DGfx** cmd0) {
     if (C0(16, 1) == 0) {
         // Push return address
         if (subGFX != nullptr) {
-            g_exec_stack.call((*cmd0), subGFX);
+            gfx->mExecStack.call((*cmd0), subGFX);
         }
     } else {
         (*cmd0) = subGFX;
-        g_exec_stack.branch(cmd);
+        gfx->mExecStack.branch(cmd);
         return true; // shortcut cmd increment
     }
     return false;
 }
 
 // TODO handle special OTR opcodes later...
-bool gfx_pushcd_handler_custom(F3DGfx** cmd0) {
-    gfx_push_current_dir((char*)(*cmd0)->words.w1);
+bool gfx_pushcd_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
+    gfx->PushCurrentDir((char*)(*cmd0)->words.w1);
     return false;
 }
 
 // TODO handle special OTR opcodes later...
-bool gfx_branch_z_otr_handler_f3dex2(F3DGfx** cmd0) {
+bool gfx_branch_z_otr_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     // Push return address
-    Interpreter* gfx = mInstance.lock().get();
     F3DGfx* cmd = (*cmd0);
 
     uint8_t vbidx = (uint8_t)((*cmd0)->words.w0 & 0x00000FFF);
@@ -3665,11 +3698,11 @@ bool gfx_branch_z_otr_handler_f3dex2(F3DGfx** cmd0) {
         (gfx->mRsp->extra_geometry_mode & G_EX_ALWAYS_EXECUTE_BRANCH) != 0) {
         uint64_t hash = ((uint64_t)(*cmd0)->words.w0 << 32) + (*cmd0)->words.w1;
 
-        F3DGfx* gfx = (F3DGfx*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(hash);
+        F3DGfx* nDL = (F3DGfx*)Ship::Context::GetInstance()->GetResourceManager()->GetResourceRawPointer(hash);
 
-        if (gfx != 0) {
-            (*cmd0) = gfx;
-            g_exec_stack.branch(cmd);
+        if (nDL != 0) {
+            (*cmd0) = nDL;
+            gfx->mExecStack.branch(cmd);
             return true; // shortcut cmd increment
         }
     }
@@ -3677,23 +3710,20 @@ bool gfx_branch_z_otr_handler_f3dex2(F3DGfx** cmd0) {
 }
 
 // F3D, F3DEX, and F3DEX2 do the same thing but F3DEX2 has its own opcode number
-bool gfx_end_dl_handler_common(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_end_dl_handler_common(Interpreter* gfx, F3DGfx** cmd0) {
     gfx->mMarkerOn = false;
-    g_exec_stack.ret();
+    gfx->mExecStack.ret();
     return true;
 }
 
-bool gfx_set_prim_depth_handler_rdp(F3DGfx** cmd) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_prim_depth_handler_rdp(Interpreter* gfx, F3DGfx** cmd) {
     uint32_t w1 = (*cmd)->words.w1;
     gfx->mRdp->prim_depth = (uint16_t)((w1 >> 16) & 0x7FFF); // Mask to 15 bits
     return false;
 }
 
 // Only on F3DEX2
-bool gfx_geometry_mode_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_geometry_mode_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpGeometryMode(~C0(0, 24), (uint32_t)cmd->words.w1);
@@ -3701,8 +3731,7 @@ bool gfx_geometry_mode_handler_f3dex2(F3DGfx** cmd0) {
 }
 
 // Only on F3DEX and older
-bool gfx_set_geometry_mode_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_geometry_mode_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpGeometryMode(0, (uint32_t)cmd->words.w1);
@@ -3710,16 +3739,14 @@ bool gfx_set_geometry_mode_handler_f3d(F3DGfx** cmd0) {
 }
 
 // Only on F3DEX and older
-bool gfx_clear_geometry_mode_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_clear_geometry_mode_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpGeometryMode((uint32_t)cmd->words.w1, 0);
     return false;
 }
 
-bool gfx_tri1_otr_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_tri1_otr_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
 
     F3DGfx* cmd = *cmd0;
     uint8_t v00 = (uint8_t)(cmd->words.w0 & 0x0000FFFF);
@@ -3730,8 +3757,7 @@ bool gfx_tri1_otr_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_tri1_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_tri1_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTri1(C0(16, 8) / 2, C0(8, 8) / 2, C0(0, 8) / 2, false);
@@ -3739,8 +3765,7 @@ bool gfx_tri1_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_tri1_handler_f3dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_tri1_handler_f3dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTri1(C1(17, 7), C1(9, 7), C1(1, 7), false);
@@ -3748,8 +3773,7 @@ bool gfx_tri1_handler_f3dex(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_tri1_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_tri1_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTri1(C1(16, 8) / 10, C1(8, 8) / 10, C1(0, 8) / 10, false);
@@ -3758,8 +3782,7 @@ bool gfx_tri1_handler_f3d(F3DGfx** cmd0) {
 }
 
 // F3DEX, and F3DEX2 share a tri2 function, however F3DEX has a different quad function.
-bool gfx_tri2_handler_f3dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_tri2_handler_f3dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTri1(C0(17, 7), C0(9, 7), C0(1, 7), false);
@@ -3767,8 +3790,7 @@ bool gfx_tri2_handler_f3dex(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_quad_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_quad_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTri1(C0(16, 8) / 2, C0(8, 8) / 2, C0(0, 8) / 2, false);
@@ -3776,8 +3798,7 @@ bool gfx_quad_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_quad_handler_f3dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_quad_handler_f3dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpTri1(C1(16, 8) / 2, C1(8, 8) / 2, C1(0, 8) / 2, false);
@@ -3785,8 +3806,7 @@ bool gfx_quad_handler_f3dex(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_othermode_l_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_othermode_l_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpSetOtherMode(31 - C0(8, 8) - C0(0, 8), C0(0, 8) + 1, cmd->words.w1);
@@ -3794,8 +3814,7 @@ bool gfx_othermode_l_handler_f3dex2(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_othermode_l_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_othermode_l_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpSetOtherMode(C0(8, 8), C0(0, 8), cmd->words.w1);
@@ -3803,8 +3822,7 @@ bool gfx_othermode_l_handler_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_othermode_h_handler_f3dex2(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_othermode_h_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpSetOtherMode(63 - C0(8, 8) - C0(0, 8), C0(0, 8) + 1, (uint64_t)cmd->words.w1 << 32);
@@ -3813,8 +3831,7 @@ bool gfx_othermode_h_handler_f3dex2(F3DGfx** cmd0) {
 }
 
 // Only on F3DEX and older
-bool gfx_set_geometry_mode_handler_f3dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_geometry_mode_handler_f3dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpGeometryMode(0, (uint32_t)cmd->words.w1);
@@ -3822,16 +3839,14 @@ bool gfx_set_geometry_mode_handler_f3dex(F3DGfx** cmd0) {
 }
 
 // Only on F3DEX and older
-bool gfx_clear_geometry_mode_handler_f3dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_clear_geometry_mode_handler_f3dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpGeometryMode((uint32_t)cmd->words.w1, 0);
     return false;
 }
 
-bool gfx_othermode_h_handler_f3d(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_othermode_h_handler_f3d(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxSpSetOtherMode(C0(8, 8) + 32, C0(0, 8), (uint64_t)cmd->words.w1 << 32);
@@ -3839,8 +3854,7 @@ bool gfx_othermode_h_handler_f3d(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_timg_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_timg_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     uintptr_t i = (uintptr_t)gfx->SegAddr(cmd->words.w1);
 
@@ -3896,7 +3910,7 @@ bool gfx_set_timg_handler_rdp(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_timg_otr_hash_handler_custom(F3DGfx** cmd0) {
+bool gfx_set_timg_otr_hash_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     uintptr_t addr = (*cmd0)->words.w1;
     (*cmd0)++;
     uint64_t hash = ((uint64_t)(*cmd0)->words.w0 << 32) + (uint64_t)(*cmd0)->words.w1;
@@ -3948,7 +3962,6 @@ bool gfx_set_timg_otr_hash_handler_custom(F3DGfx** cmd0) {
         uint32_t width = C0(0, 12) + 1;
 
         if (tex != NULL) {
-            Interpreter* gfx = mInstance.lock().get();
             gfx->GfxDpSetTextureImage(fmt, size, width, fileName, texFlags, rawTexMetadata, tex);
         }
     } else {
@@ -3959,7 +3972,7 @@ bool gfx_set_timg_otr_hash_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_timg_otr_filepath_handler_custom(F3DGfx** cmd0) {
+bool gfx_set_timg_otr_filepath_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     const char* fileName = (char*)cmd->words.w1;
 
@@ -3969,7 +3982,6 @@ bool gfx_set_timg_otr_filepath_handler_custom(F3DGfx** cmd0) {
     std::shared_ptr<Fast::Texture> texture = std::static_pointer_cast<Fast::Texture>(
         Ship::Context::GetInstance()->GetResourceManager()->LoadResourceProcess(fileName));
     if (texture != nullptr) {
-        Interpreter* gfx = mInstance.lock().get();
         texFlags = texture->Flags;
         rawTexMetadata.width = texture->Width;
         rawTexMetadata.height = texture->Height;
@@ -3990,9 +4002,8 @@ bool gfx_set_timg_otr_filepath_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_fb_handler_custom(F3DGfx** cmd0) {
+bool gfx_set_fb_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
-    Interpreter* gfx = mInstance.lock().get();
     gfx->Flush();
 
     if (cmd->words.w1) {
@@ -4007,8 +4018,7 @@ bool gfx_set_fb_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_reset_fb_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_reset_fb_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     gfx->Flush();
     gfx->mFbActive = false;
     gfx->mActiveFrameBuffer = gfx->mFrameBuffers.end();
@@ -4022,8 +4032,7 @@ bool gfx_reset_fb_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_copy_fb_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_copy_fb_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     bool* hasCopiedPtr = (bool*)cmd->words.w1;
 
@@ -4032,8 +4041,7 @@ bool gfx_copy_fb_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_read_fb_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_read_fb_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     int32_t width, height;
@@ -4041,6 +4049,7 @@ bool gfx_read_fb_handler_custom(F3DGfx** cmd0) {
     uint16_t* rgba16Buffer = (uint16_t*)cmd->words.w1;
     int fbId = C0(0, 8);
     bool bswap = C0(8, 1);
+    bool async = C0(9, 1);
     ++(*cmd0);
     cmd = *cmd0;
     // Specifying the upper left origin value is unused and unsupported at the renderer level
@@ -4050,11 +4059,17 @@ bool gfx_read_fb_handler_custom(F3DGfx** cmd0) {
     height = C1(16, 16);
 
     gfx->Flush();
-    gfx->mRapi->ReadFramebufferToCPU(fbId, width, height, rgba16Buffer);
+    bool hasData = true;
+    if (async) {
+        // The buffer receives the previous request's pixels and is left untouched when there are none yet
+        hasData = gfx->mRapi->ReadFramebufferToCPUAsync(fbId, width, height, rgba16Buffer);
+    } else {
+        gfx->mRapi->ReadFramebufferToCPU(fbId, width, height, rgba16Buffer);
+    }
 
 #ifndef IS_BIGENDIAN
     // byteswap the output to BE
-    if (bswap) {
+    if (bswap && hasData) {
         for (size_t i = 0; i < (size_t)width * height; i++) {
             rgba16Buffer[i] = BE16SWAP(rgba16Buffer[i]);
         }
@@ -4064,8 +4079,7 @@ bool gfx_read_fb_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_register_blended_texture_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_register_blended_texture_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     // Flush incase we are replacing a previous blended texture that hasn't been finialized to the GPU
@@ -4095,8 +4109,7 @@ bool gfx_register_blended_texture_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_timg_fb_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_timg_fb_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->Flush();
@@ -4106,24 +4119,21 @@ bool gfx_set_timg_fb_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_grayscale_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_grayscale_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->mRdp->grayscale = cmd->words.w1;
     return false;
 }
 
-bool gfx_load_block_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_load_block_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpLoadBlock(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
     return false;
 }
 
-bool gfx_load_block_wide_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_load_block_wide_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     uint32_t tile = cmd->words.w0 & 0x7;
@@ -4140,16 +4150,14 @@ bool gfx_load_block_wide_handler_rdp(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_load_tile_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_load_tile_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpLoadTile(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
     return false;
 }
 
-bool gfx_set_tile_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_tile_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetTile(C0(21, 3), C0(19, 2), C0(9, 9), C0(0, 9), C1(24, 3), C1(20, 4), C1(18, 2), C1(14, 4), C1(10, 4),
@@ -4157,17 +4165,15 @@ bool gfx_set_tile_handler_rdp(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_tile_size_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_tile_size_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetTileSize(C1(24, 3), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
     return false;
 }
 
-bool gfx_set_tile_size_interp_handler_rdp(F3DGfx** cmd0) {
+bool gfx_set_tile_size_interp_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
-    Interpreter* gfx = mInstance.lock().get();
 
     if (gfx->mInterpolationIndex == gfx->mInterpolationIndexTarget) {
         int tile = C1(24, 3);
@@ -4186,40 +4192,35 @@ bool gfx_set_tile_size_interp_handler_rdp(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_interpolation_index_target(F3DGfx** cmd0) {
+bool gfx_set_interpolation_index_target(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
-    Interpreter* gfx = mInstance.lock().get();
 
     gfx->mInterpolationIndexTarget = cmd->words.w1;
     return false;
 }
 
-bool gfx_load_tlut_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_load_tlut_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpLoadTlut(C1(24, 3), C1(14, 10));
     return false;
 }
 
-bool gfx_set_env_color_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_env_color_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetEnvColor(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
     return false;
 }
 
-bool gfx_set_prim_color_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_prim_color_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetPrimColor(C0(8, 8), C0(0, 8), C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
     return false;
 }
 
-bool gfx_set_fog_color_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_fog_color_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetFogColor(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
@@ -4231,8 +4232,7 @@ bool gfx_set_fog_color_handler_rdp(F3DGfx** cmd0) {
 // gating from G_SETKEYR/GB (wR/wG/wB ignored) and the YUV->RGB matrix K0..K3
 // applied during texture sampling.
 // G_SETKEYR: w1 = [wR:12 | cR:8 | sR:8]
-bool gfx_set_key_r_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_key_r_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->mRdp->key_center.r = C1(8, 8);
@@ -4241,8 +4241,7 @@ bool gfx_set_key_r_handler_rdp(F3DGfx** cmd0) {
 }
 
 // G_SETKEYGB: w0 = [op:8 | wG:12 | _:4 | wB:12], w1 = [cG:8 | sG:8 | cB:8 | sB:8]
-bool gfx_set_key_gb_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_key_gb_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->mRdp->key_center.g = C1(24, 8);
@@ -4254,8 +4253,7 @@ bool gfx_set_key_gb_handler_rdp(F3DGfx** cmd0) {
 
 // G_SETCONVERT: w0 = [op:8 | k0:9 | k1:9 | k2_hi:4], w1 = [k2_lo:5 | k3:9 | k4:9 | k5:9]
 // K0..K5 are signed 9-bit values; sign-extend after decoding.
-bool gfx_set_convert_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_convert_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->mRdp->convert_k[0] = sign_extend_9(C0(13, 9));
@@ -4268,32 +4266,28 @@ bool gfx_set_convert_handler_rdp(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_set_blend_color_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_blend_color_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetBlendColor(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
     return false;
 }
 
-bool gfx_set_fill_color_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_fill_color_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetFillColor((uint32_t)cmd->words.w1);
     return false;
 }
 
-bool gfx_set_intensity_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_intensity_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetGrayscaleColor(C1(24, 8), C1(16, 8), C1(8, 8), C1(0, 8));
     return false;
 }
 
-bool gfx_set_combine_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_combine_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
 
     gfx->GfxDpSetCombineMode(
@@ -4302,8 +4296,7 @@ bool gfx_set_combine_handler_rdp(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_tex_rect_and_flip_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_tex_rect_and_flip_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     int8_t opcode = (int8_t)(cmd->words.w0 >> 24);
     int32_t lrx, lry, tile, ulx, uly;
@@ -4328,8 +4321,7 @@ bool gfx_tex_rect_and_flip_handler_rdp(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_tex_rect_wide_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_tex_rect_wide_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     int8_t opcode = (int8_t)(cmd->words.w0 >> 24);
     int32_t lrx, lry, tile, ulx, uly;
@@ -4352,8 +4344,7 @@ bool gfx_tex_rect_wide_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_image_rect_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_image_rect_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *cmd0;
     int16_t tile, iw, ih;
     int16_t x0, y0, s0, t0;
@@ -4376,16 +4367,14 @@ bool gfx_image_rect_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_fill_rect_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_fill_rect_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     gfx->GfxDpFillRectangle(C1(12, 12), C1(0, 12), C0(12, 12), C0(0, 12));
     return false;
 }
 
-bool gfx_fill_wide_rect_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_fill_wide_rect_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
     int32_t lrx, lry, ulx, uly;
 
@@ -4399,40 +4388,35 @@ bool gfx_fill_wide_rect_handler_custom(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_SetScissor_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_SetScissor_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     gfx->GfxDpSetScissor(C1(24, 2), C0(12, 12), C0(0, 12), C1(12, 12), C1(0, 12));
     return false;
 }
 
-bool gfx_set_z_img_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_z_img_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     gfx->GfxDpSetZImage(gfx->SegAddr(cmd->words.w1));
     return false;
 }
 
-bool gfx_set_c_img_handler_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_set_c_img_handler_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     gfx->GfxDpSetColorImage(C0(21, 3), C0(19, 2), C0(0, 11), gfx->SegAddr(cmd->words.w1));
     return false;
 }
 
-bool gfx_rdp_set_other_mode_rdp(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_rdp_set_other_mode_rdp(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     gfx->GfxDpSetOtherMode(C0(0, 24), (uint32_t)cmd->words.w1);
     return false;
 }
 
-bool gfx_bg_copy_handler_s2dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_bg_copy_handler_s2dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     if (!gfx->mMarkerOn) {
@@ -4441,16 +4425,14 @@ bool gfx_bg_copy_handler_s2dex(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_bg_1cyc_handler_s2dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_bg_1cyc_handler_s2dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     gfx->Gfxs2dexBg1cyc((F3DuObjBg*)cmd->words.w1);
     return false;
 }
 
-bool gfx_obj_rectangle_handler_s2dex(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_obj_rectangle_handler_s2dex(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     if (!gfx->mMarkerOn) {
@@ -4459,19 +4441,18 @@ bool gfx_obj_rectangle_handler_s2dex(F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_extra_geometry_mode_handler_custom(F3DGfx** cmd0) {
-    Interpreter* gfx = mInstance.lock().get();
+bool gfx_extra_geometry_mode_handler_custom(Interpreter* gfx, F3DGfx** cmd0) {
     F3DGfx* cmd = *(cmd0);
 
     gfx->GfxSpExtraGeometryMode(~C0(0, 24), (uint32_t)cmd->words.w1);
     return false;
 }
 
-bool gfx_stubbed_command_handler(F3DGfx** cmd0) {
+bool gfx_stubbed_command_handler(Interpreter* gfx, F3DGfx** cmd0) {
     return false;
 }
 
-bool gfx_spnoop_command_handler_f3dex2(F3DGfx** cmd0) {
+bool gfx_spnoop_command_handler_f3dex2(Interpreter* gfx, F3DGfx** cmd0) {
     return false;
 }
 
@@ -4661,7 +4642,7 @@ static constexpr std::array ucode_handlers = {
     &s2dexHandlers,  // ucode_s2dex
 };
 
-const char* GfxGetOpcodeName(int8_t opcode) {
+const char* GfxGetOpcodeName(int8_t opcode, UcodeHandlers ucode) {
     if (otrHandlers.contains(opcode)) {
         return otrHandlers.at(opcode).first;
     }
@@ -4670,27 +4651,31 @@ const char* GfxGetOpcodeName(int8_t opcode) {
         return rdpHandlers.at(opcode).first;
     }
 
-    if (ucode_handler_index < ucode_handlers.size()) {
-        if (ucode_handlers[ucode_handler_index]->contains(opcode)) {
-            return ucode_handlers[ucode_handler_index]->at(opcode).first;
+    if (ucode < ucode_handlers.size()) {
+        if (ucode_handlers[ucode]->contains(opcode)) {
+            return ucode_handlers[ucode]->at(opcode).first;
         } else {
             SPDLOG_CRITICAL("Unhandled OP code: 0x{:X}, for loaded ucode: {}", (uint8_t)opcode,
-                            (uint32_t)ucode_handler_index);
+                            (uint32_t)ucode);
         }
     } else {
-        SPDLOG_CRITICAL("Unhandled OP code: 0x{:X}, invalid ucode: {}", (uint8_t)opcode, (uint32_t)ucode_handler_index);
+        SPDLOG_CRITICAL("Unhandled OP code: 0x{:X}, invalid ucode: {}", (uint8_t)opcode, (uint32_t)ucode);
     }
 
     return nullptr;
 }
 
+const char* GfxGetOpcodeName(int8_t opcode) {
+    Interpreter* gfx = GetActiveInstance();
+    return GfxGetOpcodeName(opcode, gfx != nullptr ? gfx->mUcodeHandlerIndex : ucode_f3dex2);
+}
+
 // TODO, implement a system where we can get the current opcode handler by writing to the GWords. If the powers that be
 // are OK with that...
-static void gfx_set_ucode_handler(UcodeHandlers ucode) {
+void Interpreter::LoadUcode(UcodeHandlers ucode) {
     // Loaded ucode must be in range of the supported ucode_handlers
     assert(ucode < ucode_max);
-    Interpreter* gfx = mInstance.lock().get();
-    ucode_handler_index = ucode;
+    mUcodeHandlerIndex = ucode;
 
     // Reset some RSP state values upon ucode load to deal with hardware quirks discovered by emulators
     switch (ucode) {
@@ -4699,35 +4684,26 @@ static void gfx_set_ucode_handler(UcodeHandlers ucode) {
         case ucode_f3dex:
         case ucode_f3dexb:
         case ucode_f3dex2:
-            gfx->mRsp->fog_mul = 0;
-            gfx->mRsp->fog_offset = 0;
+            mRsp->fog_mul = 0;
+            mRsp->fog_offset = 0;
             break;
         default:
             break;
     }
 }
 
-static void gfx_step() {
-    auto& cmd = g_exec_stack.currCmd();
+void Interpreter::Step() {
+    auto& cmd = mExecStack.currCmd();
     auto cmd0 = cmd;
     int8_t opcode = (int8_t)(cmd->words.w0 >> 24);
 
-#ifdef USE_GBI_TRACE
-    if (cmd->words.trace.valid &&
-        Ship::Context::GetInstance()->GetConsoleVariables()->GetInteger("gEnableGFXTrace", 0)) {
-#define TRACE                                  \
-    "\n====================================\n" \
-    " - CMD: {:02X}\n"                         \
-    " - Path: {}:{}\n"                         \
-    " - W0: {:08X}\n"                          \
-    " - W1: {:08X}\n"                          \
-    "===================================="
-        SPDLOG_INFO(TRACE, (uint8_t)opcode, cmd->words.trace.file, cmd->words.trace.idx, cmd->words.w0, cmd->words.w1);
+    if (mGfxTraceRecorder != nullptr && mGfxTraceRecorder->IsEnabled()) {
+        mGfxTraceRecorder->Record(opcode, (uint8_t)mUcodeHandlerIndex, cmd->words.w0, cmd->words.w1,
+                                  mExecStack.depth());
     }
-#endif
 
     if (opcode == F3DEX2_G_LOAD_UCODE) {
-        gfx_set_ucode_handler((UcodeHandlers)(cmd->words.w0 & 0xFFFFFF));
+        LoadUcode((UcodeHandlers)(cmd->words.w0 & 0xFFFFFF));
         ++cmd;
         return;
         // Instead of having a handler for each ucode for switching ucode, just check for it early and return.
@@ -4745,28 +4721,28 @@ static void gfx_step() {
                 || w1 > 0x0000FFFFFFFFFFFFull
 #endif
             ) {
-                ++g_exec_stack.currCmd();
+                ++mExecStack.currCmd();
                 return;
             }
         }
-        if (otrHandlers.at(opcode).second(&cmd)) {
+        if (otrHandlers.at(opcode).second(this, &cmd)) {
             return;
         }
     } else if (rdpHandlers.contains(opcode)) {
-        if (rdpHandlers.at(opcode).second(&cmd)) {
+        if (rdpHandlers.at(opcode).second(this, &cmd)) {
             return;
         }
-    } else if (ucode_handler_index < ucode_handlers.size()) {
-        if (ucode_handlers[ucode_handler_index]->contains(opcode)) {
-            if (ucode_handlers[ucode_handler_index]->at(opcode).second(&cmd)) {
+    } else if (mUcodeHandlerIndex < ucode_handlers.size()) {
+        if (ucode_handlers[mUcodeHandlerIndex]->contains(opcode)) {
+            if (ucode_handlers[mUcodeHandlerIndex]->at(opcode).second(this, &cmd)) {
                 return;
             }
         } else {
             SPDLOG_CRITICAL("Unhandled OP code: 0x{:X}, for loaded ucode: {}", (uint8_t)opcode,
-                            (uint32_t)ucode_handler_index);
+                            (uint32_t)mUcodeHandlerIndex);
         }
     } else {
-        SPDLOG_CRITICAL("Unhandled OP code: 0x{:X}, invalid ucode: {}", (uint8_t)opcode, (uint32_t)ucode_handler_index);
+        SPDLOG_CRITICAL("Unhandled OP code: 0x{:X}, invalid ucode: {}", (uint8_t)opcode, (uint32_t)mUcodeHandlerIndex);
     }
 
     ++cmd;
@@ -4831,7 +4807,7 @@ void Interpreter::Init(class GfxWindowBackend* wapi, class GfxRenderingAPI* rapi
         mTexUploadBuffer = (uint8_t*)malloc(max_tex_size * max_tex_size * 4);
     }
 
-    ucode_handler_index = UcodeHandlers::ucode_f3dex2;
+    mUcodeHandlerIndex = UcodeHandlers::ucode_f3dex2;
 
     // Pre-allocate texture cache buckets to prevent rehash-induced iterator invalidation.
     mTextureCache.map.reserve(TEXTURE_CACHE_MAX_SIZE);
@@ -4861,6 +4837,14 @@ std::shared_ptr<GfxDebugger> Interpreter::GetGfxDebugger() const {
     return mGfxDebugger;
 }
 
+void Interpreter::SetGfxTraceRecorder(std::shared_ptr<GfxTraceRecorder> recorder) {
+    mGfxTraceRecorder = std::move(recorder);
+}
+
+std::shared_ptr<GfxTraceRecorder> Interpreter::GetGfxTraceRecorder() const {
+    return mGfxTraceRecorder;
+}
+
 void Interpreter::HandleWindowEvents() {
     mWapi->HandleEvents();
 }
@@ -4933,8 +4917,6 @@ void Interpreter::StartFrame() {
     mFbActive = false;
 }
 
-GfxExecStack g_exec_stack = {};
-
 void Interpreter::RunGuiOnly() {
     SpReset();
 
@@ -4992,14 +4974,16 @@ void Interpreter::Run(Gfx* commands, const std::unordered_map<Mtx*, MtxF>& mtx_r
     mRenderingState.viewport = {};
     mRenderingState.scissor = {};
 
-    auto dbg = mGfxDebugger;
-    g_exec_stack.start((F3DGfx*)commands);
-    while (!g_exec_stack.cmd_stack.empty()) {
-        auto cmd = g_exec_stack.cmd_stack.top();
+    // Hold the interpreter alive for the whole frame; command handlers receive it as a plain pointer
+    const std::shared_ptr<Interpreter> self = shared_from_this();
+    const ThreadScope scope(this);
 
-        if (dbg->IsDebugging()) {
-            g_exec_stack.gfx_path.push_back(cmd);
-            if (dbg->HasBreakPoint(g_exec_stack.gfx_path)) {
+    auto dbg = mGfxDebugger;
+    const bool debugging = dbg->IsDebugging();
+    mExecStack.start((F3DGfx*)commands, debugging);
+    while (!mExecStack.empty()) {
+        if (debugging) {
+            if (dbg->HasBreakPoint(mExecStack.currPath())) {
                 // On a breakpoint with the active framebuffer still set, we need to reset back to prevent
                 // soft locking the renderer
                 if (mFbActive) {
@@ -5009,14 +4993,22 @@ void Interpreter::Run(Gfx* commands, const std::unordered_map<Mtx*, MtxF>& mtx_r
 
                 break;
             }
-            g_exec_stack.gfx_path.pop_back();
         }
-        gfx_step();
+        Step();
     }
 
     Flush();
+
+    // The display list has executed, so the game framebuffer holds this frame's depth. Queue the asynchronous depth
+    // reads now, before it is resolved or cleared for the next frame.
+    if (!mGetPixelDepthAsyncPending.empty()) {
+        mRapi->RequestPixelDepthAsync(mRendersToFb ? mGameFb : 0, mGetPixelDepthAsyncPending);
+        mGetPixelDepthAsyncPending.clear();
+        mGetPixelDepthAsyncInFlight = true;
+    }
+
     mGfxFrameBuffer = 0;
-    currentDir = std::stack<std::string>();
+    mCurrentDir = std::stack<std::string>();
 
     if (mRendersToFb) {
         mRapi->StartDrawToFramebuffer(0, 1);
@@ -5047,8 +5039,20 @@ void Interpreter::EndFrame() {
     mWapi->SwapBuffersEnd();
 }
 
+void Interpreter::SetTextureFilter(FilteringMode mode) {
+    // Textures are created with the filter that was set at the time
+    TextureCacheClear();
+    mRapi->SetTextureFilter(mode);
+}
+
+void Interpreter::SetTargetUcode(UcodeHandlers ucode) {
+    mUcodeHandlerIndex = ucode;
+}
+
 void gfx_set_target_ucode(UcodeHandlers ucode) {
-    ucode_handler_index = ucode;
+    if (Interpreter* gfx = GetActiveInstance()) {
+        gfx->SetTargetUcode(ucode);
+    }
 }
 
 int Interpreter::GetTargetFps() {
@@ -5163,11 +5167,41 @@ uint16_t Interpreter::GetPixelDepth(float x, float y) {
     return mGetPixelDepthCached.find(std::make_pair(x, y))->second;
 }
 
-void gfx_push_current_dir(char* path) {
+uint16_t Interpreter::GetPixelDepthAsync(float x, float y) {
+    AdjustPixelDepthCoordinates(x, y);
+
+    // Results of the previous frame's readback are collected lazily on the first query of the next frame
+    if (mGetPixelDepthAsyncInFlight) {
+        mGetPixelDepthAsyncCached = mRapi->CollectPixelDepthAsync();
+        mGetPixelDepthAsyncInFlight = false;
+    }
+
+    mGetPixelDepthAsyncPending.emplace(x, y);
+
+    if (auto it = mGetPixelDepthAsyncCached.find(std::make_pair(x, y)); it != mGetPixelDepthAsyncCached.end()) {
+        return it->second;
+    }
+
+    return 0;
+}
+
+void Interpreter::GetPixelDepthBatchAsync(const float* xs, const float* ys, uint16_t* depths, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        depths[i] = GetPixelDepthAsync(xs[i], ys[i]);
+    }
+}
+
+void Interpreter::PushCurrentDir(char* path) {
     if (gfx_check_image_signature(path) == 1)
         path = &path[7];
 
-    currentDir.push(GetPathWithoutFileName(path));
+    mCurrentDir.push(GetPathWithoutFileName(path));
+}
+
+void gfx_push_current_dir(char* path) {
+    if (Interpreter* gfx = GetActiveInstance()) {
+        gfx->PushCurrentDir(path);
+    }
 }
 
 int32_t gfx_check_image_signature(const char* imgData) {
@@ -5207,7 +5241,15 @@ void Interpreter::RegisterBlendedTexture(const char* name, uint8_t* mask, uint8_
         replacement = tex->ImageData;
     }
 
-    mMaskedTextures[name] = MaskedTextureEntry{ mask, replacement };
+    auto it = mMaskedTextures.insert_or_assign(name, MaskedTextureEntry{ mask, replacement }).first;
+
+    // Point the resources already resolved for this path at the new entry
+    for (auto& [resource, lookup] : mMaskedTextureLookups) {
+        std::shared_ptr<Fast::Texture> tex = lookup.resource.lock();
+        if (tex != nullptr && GetBaseTexturePath(tex->GetInitData()->Path) == it->first) {
+            lookup.entry = &it->second;
+        }
+    }
 }
 
 void Interpreter::UnregisterBlendedTexture(const char* name) {
@@ -5215,7 +5257,40 @@ void Interpreter::UnregisterBlendedTexture(const char* name) {
         name += 7;
     }
 
-    mMaskedTextures.erase(name);
+    auto it = mMaskedTextures.find(std::string_view(name));
+    if (it == mMaskedTextures.end()) {
+        return;
+    }
+
+    for (auto& [resource, lookup] : mMaskedTextureLookups) {
+        if (lookup.entry == &it->second) {
+            lookup.entry = nullptr;
+        }
+    }
+    mMaskedTextures.erase(it);
+}
+
+const MaskedTextureEntry* Interpreter::FindMaskedTexture(const std::shared_ptr<Fast::Texture>& resource) {
+    // Most games never register a blended texture
+    if (resource == nullptr || mMaskedTextures.empty()) {
+        return nullptr;
+    }
+
+    // An expired entry means the resource was freed and its address reused
+    auto it = mMaskedTextureLookups.find(resource.get());
+    if (it != mMaskedTextureLookups.end() && !it->second.resource.expired()) {
+        return it->second.entry;
+    }
+
+    // Like the S2DEX background cache, start over when full. Lookups are cheap to redo.
+    if (mMaskedTextureLookups.size() >= MASKED_TEXTURE_LOOKUP_MAX_SIZE) {
+        mMaskedTextureLookups.clear();
+    }
+
+    auto maskIter = mMaskedTextures.find(GetBaseTexturePath(resource->GetInitData()->Path));
+    const MaskedTextureEntry* entry = maskIter != mMaskedTextures.end() ? &maskIter->second : nullptr;
+    mMaskedTextureLookups.insert_or_assign(resource.get(), MaskedTextureLookup{ resource, entry });
+    return entry;
 }
 
 // New getters and setters
@@ -5324,25 +5399,25 @@ void gfx_cc_get_features(uint64_t shader_id0, uint64_t shader_id1, struct CCFeat
 
 extern "C" int gfx_create_framebuffer(uint32_t width, uint32_t height, uint32_t native_width, uint32_t native_height,
                                       uint8_t resize) {
-    return Fast::mInstance.lock().get()->CreateFrameBuffer(width, height, native_width, native_height, resize);
+    return Fast::GetActiveInstance()->CreateFrameBuffer(width, height, native_width, native_height, resize);
 }
 
 extern "C" void gfx_texture_cache_clear() {
-    Fast::mInstance.lock().get()->TextureCacheClear();
+    Fast::GetActiveInstance()->TextureCacheClear();
 }
 
 extern "C" void gfx_shader_cache_clear() {
-    auto instance = Fast::mInstance.lock().get();
+    auto instance = Fast::GetActiveInstance();
     instance->mColorCombinerPool.clear();
-    instance->mPrevCombiner = Fast::mInstance.lock().get()->mColorCombinerPool.end();
+    instance->mPrevCombiner = instance->mColorCombinerPool.end();
     instance->mRenderingState.mShaderProgram = nullptr;
     instance->mRapi->ClearShaderCache();
 }
 
 extern "C" void gfx_register_fb_texture(const void* cpuAddr, int fbId) {
-    Fast::mInstance.lock().get()->RegisterFbTexture(cpuAddr, fbId);
+    Fast::GetActiveInstance()->RegisterFbTexture(cpuAddr, fbId);
 }
 
 extern "C" void gfx_unregister_fb_texture(const void* cpuAddr) {
-    Fast::mInstance.lock().get()->UnregisterFbTexture(cpuAddr);
+    Fast::GetActiveInstance()->UnregisterFbTexture(cpuAddr);
 }
\ No newline at end of file
@@ -29,3 +29,22 @@ extern "C" uint16_t GfxGetPixelDepth(float x, float y) {
     }
     return wnd->GetPixelDepth(x, y);
 }
+
+extern "C" uint16_t GfxGetPixelDepthAsync(float x, float y) {
+    auto wnd = std::dynamic_pointer_cast<Fast::Fast3dWindow>(Ship::Context::GetInstance()->GetWindow());
+    if (wnd == nullptr) {
+        return 0;
+    }
+    return wnd->GetPixelDepthAsync(x, y);
+}
+
+extern "C" void GfxGetPixelDepthBatchAsync(const float* xs, const float* ys, uint16_t* depths, uint32_t count) {
+    auto wnd = std::dynamic_pointer_cast<Fast::Fast3dWindow>(Ship::Context::GetInstance()->GetWindow());
+    if (wnd == nullptr) {
+        for (uint32_t i = 0; i < count; i++) {
+            depths[i] = 0;
+        }
+        return;
+    }
+    wnd->GetPixelDepthBatchAsync(xs, ys, depths, count);
+}
@@ -7,6 +7,11 @@ static std::shared_ptr<Fast::GfxDebugger> GetGfxDebugger() {
     return window ? window->GetGfxDebugger() : nullptr;
 }
 
+static std::shared_ptr<Fast::GfxTraceRecorder> GetGfxTraceRecorder() {
+    auto window = std::dynamic_pointer_cast<Fast::Fast3dWindow>(Ship::Context::GetInstance()->GetWindow());
+    return window ? window->GetGfxTraceRecorder() : nullptr;
+}
+
 void GfxDebuggerRequestDebugging() {
     if (auto dbg = GetGfxDebugger()) {
         dbg->RequestDebugging();
@@ -25,3 +30,22 @@ void GfxDebuggerDebugDisplayList(void* cmds) {
         dbg->DebugDisplayList((Fast::F3DGfx*)cmds);
     }
 }
+
+void GfxTraceSetEnabled(bool enabled) {
+    if (auto trace = GetGfxTraceRecorder()) {
+        trace->SetEnabled(enabled);
+    }
+}
+bool GfxTraceIsEnabled() {
+    auto trace = GetGfxTraceRecorder();
+    return trace ? trace->IsEnabled() : false;
+}
+void GfxTraceClear() {
+    if (auto trace = GetGfxTraceRecorder()) {
+        trace->Clear();
+    }
+}
+bool GfxTraceDump(const char* path) {
+    auto trace = GetGfxTraceRecorder();
+    return trace ? trace->Dump(path) : false;
+}
@@ -441,9 +441,11 @@ void GfxDebuggerWindow::DrawDisasNode(const F3DGfx* cmd, std::vector<const F3DGf
             case OTR_G_READFB: {
                 int fbId = C0(0, 8);
                 bool bswap = C0(8, 1);
+                bool async = C0(9, 1);
                 cmd++;
-                nodeWithText(cmd0, fmt::format("G_READFB: src FB {}, byteswap {}, ulx {}, uly {}, width {}, height {}",
-                                               fbId, bswap, C0(0, 16), C0(16, 16), C1(0, 16), C1(16, 16)));
+                nodeWithText(cmd0,
+                             fmt::format("G_READFB: src FB {}, byteswap {}, async {}, ulx {}, uly {}, width {}, height {}",
+                                         fbId, bswap, async, C0(0, 16), C0(16, 16), C1(0, 16), C1(16, 16)));
                 cmd++;
                 break;
             }
@@ -615,7 +617,7 @@ void GfxDebuggerWindow::DrawDisas() {
         {
             ImGui::Text("Disp Stack");
             ImGui::BeginChild("### Disp Stack", ImVec2(400.0f, 0.0f), true, ImGuiWindowFlags_HorizontalScrollbar);
-            for (auto& disp : g_exec_stack.disp_stack) {
+            for (auto& disp : mInterpreter.lock()->mExecStack.disp_stack) {
                 ImGui::Text("%s", fmt::format("{}:{}", disp.file, disp.line).c_str());
             }
             ImGui::EndChild();
@@ -719,6 +721,18 @@ void GfxDebuggerWindow::DrawElement() {
         if (ImGui::Button("Debug")) {
             dbg->RequestDebugging();
         }
+
+        auto trace = std::dynamic_pointer_cast<Fast::Fast3dWindow>(Ship::Context::GetInstance()->GetWindow())
+                         ->GetGfxTraceRecorder();
+        bool tracing = trace->IsEnabled();
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Record GBI Trace", &tracing)) {
+            trace->SetEnabled(tracing);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Dump Trace")) {
+            trace->Dump(Ship::Context::GetPathRelativeToAppDirectory("gbi_trace.bin"));
+        }
     } else {
         bool resumed = false;
         if (ImGui::Button("Resume Game")) {
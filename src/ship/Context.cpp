@@ -1,5 +1,6 @@
 #include "ship/Context.h"
 #include "ship/controller/controldevice/controller/mapping/keyboard/KeyboardScancodes.h"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <spdlog/sinks/rotating_file_sink.h>
@@ -10,6 +11,7 @@
 #include "ship/debug/CrashHandler.h"
 #include "ship/window/FileDropMgr.h"
 #include "ship/events/EventSystem.h"
+#include "ship/resource/archive/O2rArchive.h"
 #ifdef ENABLE_SCRIPTING
 #include "ship/scripting/ScriptLoader.h"
 #include "ship/security/Keystore.h"
@@ -56,6 +58,7 @@ Context::~Context() {
     mKeystore = nullptr;
 #endif
     GetConfig()->Save();
+    GetConfig()->Flush();
     mConfig = nullptr;
     spdlog::shutdown();
 }
@@ -224,6 +227,10 @@ bool Context::InitResourceManager(const std::vector<std::string>& archivePaths,
     InitKeystore();
 #endif
 
+    if (GetConfig()->GetBool("Game.Archive Index Cache", false)) {
+        O2rArchive::SetIndexCacheDirectory(GetPathRelativeToAppDirectory("cache/archives"));
+    }
+
     mMainPath = GetConfig()->GetString("Game.Main Archive", GetAppDirectoryPath());
     mPatchesPath = GetConfig()->GetString("Game.Patches Archive", GetAppDirectoryPath() + "/mods");
     if (archivePaths.empty()) {
@@ -238,6 +245,10 @@ bool Context::InitResourceManager(const std::vector<std::string>& archivePaths,
         GetResourceManager()->Init(archivePaths, validHashes, reservedThreadCount);
     }
 
+    // In MiB, 0 keeps every loaded resource cached
+    GetResourceManager()->SetMemoryBudget((size_t)std::max(GetConfig()->GetInt("Game.Resource Cache Budget", 0), 0) *
+                                          1024 * 1024);
+
     if (!allowEmptyPaths && !GetResourceManager()->IsLoaded()) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "OTR file not found",
                                  "Main OTR file not found. Please generate one", nullptr);
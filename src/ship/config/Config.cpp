@@ -5,10 +5,19 @@
 #include <filesystem>
 #include <unordered_map>
 #include <any>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
 #include <spdlog/spdlog.h>
 #include "ship/utils/StringHelper.h"
 #include "ship/Context.h"
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace fs = std::filesystem;
 
 namespace Ship {
@@ -18,6 +27,15 @@ Config::Config(std::string path) : mPath(std::move(path)), mIsNewInstance(false)
 
 Config::~Config() {
     SPDLOG_TRACE("destruct config");
+    {
+        std::lock_guard<std::mutex> lock(mSaveMutex);
+        mSaveStopping = true;
+    }
+    mSaveRequested.notify_one();
+    if (mSaveThread.joinable()) {
+        // The thread writes the last pending save before it exits
+        mSaveThread.join();
+    }
 }
 
 std::string Config::FormatNestedKey(const std::string& key) {
@@ -105,27 +123,40 @@ bool Config::Contains(const std::string& key) {
 }
 
 void Config::SetString(const std::string& key, const std::string& value) {
-    mFlattenedJson[FormatNestedKey(key)] = value;
+    const std::string flattenedKey = FormatNestedKey(key);
+    mFlattenedJson[flattenedKey] = value;
+    MarkDirty(flattenedKey);
 }
 
 void Config::SetFloat(const std::string& key, float value) {
-    mFlattenedJson[FormatNestedKey(key)] = value;
+    const std::string flattenedKey = FormatNestedKey(key);
+    mFlattenedJson[flattenedKey] = value;
+    MarkDirty(flattenedKey);
 }
 
 void Config::SetBool(const std::string& key, bool value) {
-    mFlattenedJson[FormatNestedKey(key)] = value;
+    const std::string flattenedKey = FormatNestedKey(key);
+    mFlattenedJson[flattenedKey] = value;
+    MarkDirty(flattenedKey);
 }
 
 void Config::SetInt(const std::string& key, int32_t value) {
-    mFlattenedJson[FormatNestedKey(key)] = value;
+    const std::string flattenedKey = FormatNestedKey(key);
+    mFlattenedJson[flattenedKey] = value;
+    MarkDirty(flattenedKey);
 }
 
 void Config::SetUInt(const std::string& key, uint32_t value) {
-    mFlattenedJson[FormatNestedKey(key)] = value;
+    const std::string flattenedKey = FormatNestedKey(key);
+    mFlattenedJson[flattenedKey] = value;
+    MarkDirty(flattenedKey);
 }
 
 void Config::Erase(const std::string& key) {
-    mFlattenedJson.erase(FormatNestedKey(key));
+    const std::string flattenedKey = FormatNestedKey(key);
+    if (mFlattenedJson.erase(flattenedKey) != 0) {
+        MarkDirty(flattenedKey);
+    }
 }
 
 void Config::SetBlock(const std::string& key, nlohmann::json block) {
@@ -154,6 +185,7 @@ void Config::SetBlock(const std::string& key, nlohmann::json block) {
         gjson[key] = block;
     }
     mFlattenedJson = gjson.flatten();
+    MarkAllDirty();
     Save();
 }
 
@@ -182,6 +214,7 @@ void Config::EraseBlock(const std::string& key) {
         }
     }
     mFlattenedJson = gjson.flatten();
+    MarkAllDirty();
     Save();
 }
 
@@ -190,10 +223,13 @@ void Config::Copy(const std::string& fromKey, const std::string& toKey) {
     auto nestedToKey = FormatNestedKey(toKey);
     if (mFlattenedJson.contains(nestedFromKey)) {
         mFlattenedJson[nestedToKey] = mFlattenedJson[nestedFromKey];
+        MarkDirty(nestedToKey);
     }
 }
 
 void Config::Reload() {
+    Flush();
+    MarkAllDirty();
     if (mPath == "None" || !fs::exists(mPath) || !fs::is_regular_file(mPath)) {
         mIsNewInstance = true;
         mFlattenedJson = nlohmann::json::object();
@@ -205,16 +241,278 @@ void Config::Reload() {
     mFlattenedJson = nlohmann::json::object();
     try {
         mNestedJson = nlohmann::json::parse(ifs);
+        mNestedJsonStale = false;
         mFlattenedJson = mNestedJson.flatten();
     } catch (const nlohmann::json::exception& e) {
         SPDLOG_ERROR("Failed to parse config file {}: {}", mPath, e.what());
     } catch (const std::exception& e) { SPDLOG_ERROR("Unexpected error loading config file {}: {}", mPath, e.what()); }
 }
 
+std::string Config::GetBlockKey(const std::string& flattenedKey) {
+    // "/CVars/gSettings/gVolume" belongs to "/CVars/gSettings", "/ConfigVersion" is a block of its own
+    const size_t separator = flattenedKey.find('/', 1);
+    if (separator == std::string::npos) {
+        return flattenedKey;
+    }
+    return flattenedKey.substr(0, flattenedKey.find('/', separator + 1));
+}
+
+void Config::MarkDirty(const std::string& flattenedKey) {
+    if (!mAllDirty) {
+        mDirtyBlocks.insert(GetBlockKey(flattenedKey));
+    }
+}
+
+void Config::MarkAllDirty() {
+    mAllDirty = true;
+    mDirtyBlocks.clear();
+}
+
+std::optional<nlohmann::json> Config::CollectBlock(const std::string& block) {
+    const auto& values = mFlattenedJson.get_ref<const nlohmann::json::object_t&>();
+    nlohmann::json collected = nlohmann::json::object();
+    // Keys of blocks sharing the prefix (e.g. "/CVars/gAudio" and "/CVars/gAudioBackend") are interleaved
+    for (auto it = values.lower_bound(block); it != values.end() && it->first.compare(0, block.size(), block) == 0;
+         ++it) {
+        if (it->first.size() == block.size() || it->first[block.size()] == '/') {
+            collected[it->first.substr(block.size())] = it->second;
+        }
+    }
+
+    if (collected.empty()) {
+        return std::nullopt;
+    }
+    return collected;
+}
+
 void Config::Save() {
-    std::ofstream file(mPath);
-    mNestedJson = mFlattenedJson.unflatten();
-    file << mNestedJson.dump(4);
+    mNestedJsonStale = true;
+    if (mSaveResync.exchange(false)) {
+        MarkAllDirty();
+    }
+    // Only the changed blocks are copied here, serializing happens on the writer thread
+    auto request = std::make_unique<SaveRequest>();
+    if (mAllDirty) {
+        request->Reset = true;
+        for (auto it = mFlattenedJson.begin(); it != mFlattenedJson.end(); ++it) {
+            // An empty key only stands for an empty document
+            if (it.key().empty()) {
+                continue;
+            }
+            const std::string block = GetBlockKey(it.key());
+            auto& values = request->Blocks[block];
+            if (!values.has_value()) {
+                values = nlohmann::json::object();
+            }
+            (*values)[it.key().substr(block.size())] = it.value();
+        }
+    } else {
+        for (const auto& block : mDirtyBlocks) {
+            request->Blocks[block] = CollectBlock(block);
+        }
+    }
+    mAllDirty = false;
+    mDirtyBlocks.clear();
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mSaveMutex);
+    if (mPendingSave == nullptr) {
+        mFirstSaveRequest = now;
+        mPendingSave = std::move(request);
+    } else if (request->Reset) {
+        mPendingSave = std::move(request);
+    } else {
+        for (auto& [block, values] : request->Blocks) {
+            mPendingSave->Blocks.insert_or_assign(block, std::move(values));
+        }
+    }
+    mLastSaveRequest = now;
+    if (!mSaveThread.joinable()) {
+        mSaveThread = std::thread(&Config::SaveThread, this);
+    }
+    mSaveRequested.notify_one();
+}
+
+void Config::Flush() {
+    std::unique_lock<std::mutex> lock(mSaveMutex);
+    if (mPendingSave == nullptr && !mSaveWriting) {
+        return;
+    }
+    mSaveFlushing = true;
+    mSaveRequested.notify_one();
+    mSaveFinished.wait(lock, [this] { return mPendingSave == nullptr && !mSaveWriting; });
+    mSaveFlushing = false;
+}
+
+void Config::SetSaveDelay(std::chrono::milliseconds delay) {
+    std::lock_guard<std::mutex> lock(mSaveMutex);
+    mSaveDelay = std::max(delay, std::chrono::milliseconds(0));
+    mSaveRequested.notify_one();
+}
+
+void Config::SaveThread() {
+    std::unique_lock<std::mutex> lock(mSaveMutex);
+    while (true) {
+        mSaveRequested.wait(lock, [this] { return mSaveStopping || mPendingSave != nullptr; });
+        if (mPendingSave == nullptr) {
+            break;
+        }
+
+        // Coalesce requests until they stop coming in for the save delay, but don't hold a write back indefinitely
+        while (!mSaveStopping && !mSaveFlushing) {
+            const auto deadline = std::min(mLastSaveRequest + mSaveDelay, mFirstSaveRequest + mSaveDelay * 4);
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            mSaveRequested.wait_until(lock, deadline);
+        }
+
+        std::unique_ptr<SaveRequest> request = std::move(mPendingSave);
+        mSaveWriting = true;
+        lock.unlock();
+        Write(*request);
+        lock.lock();
+        mSaveWriting = false;
+        mSaveFinished.notify_all();
+    }
+}
+
+// Inverse of the escaping of json pointer reference tokens
+static std::string UnescapeToken(std::string token) {
+    for (size_t pos = token.find('~'); pos != std::string::npos && pos + 1 < token.size();
+         pos = token.find('~', pos + 1)) {
+        if (token[pos + 1] == '1') {
+            token.replace(pos, 2, "/");
+        } else if (token[pos + 1] == '0') {
+            token.erase(pos + 1, 1);
+        }
+    }
+    return token;
+}
+
+// Reindents a value serialized at the top level for its place two levels down
+static std::string IndentBlock(const std::string& serialized) {
+    std::string indented;
+    indented.reserve(serialized.size());
+    for (char c : serialized) {
+        indented += c;
+        if (c == '\n') {
+            indented += "        ";
+        }
+    }
+    return indented;
+}
+
+std::string Config::Serialize(const SaveRequest& request) {
+    if (request.Reset) {
+        mSerializedTree.clear();
+    }
+    for (const auto& [block, values] : request.Blocks) {
+        const size_t separator = block.find('/', 1);
+        const std::string name = UnescapeToken(block.substr(1, separator == std::string::npos ? separator : separator - 1));
+        SerializedNode& node = mSerializedTree[name];
+        if (separator == std::string::npos) {
+            node.Value = values.has_value() ? std::optional(values->unflatten().dump(4)) : std::nullopt;
+        } else if (values.has_value()) {
+            node.Children[UnescapeToken(block.substr(separator + 1))] = IndentBlock(values->unflatten().dump(4));
+        } else {
+            node.Children.erase(UnescapeToken(block.substr(separator + 1)));
+        }
+        if (!node.Value.has_value() && node.Children.empty()) {
+            mSerializedTree.erase(name);
+        }
+    }
+
+    // Assemble the cached blocks the way dump(4) lays out the whole tree
+    if (mSerializedTree.empty()) {
+        return "{}";
+    }
+    std::string contents = "{\n";
+    for (auto it = mSerializedTree.begin(); it != mSerializedTree.end(); ++it) {
+        const auto& [name, node] = *it;
+        if (it != mSerializedTree.begin()) {
+            contents += ",\n";
+        }
+        contents += "    " + nlohmann::json(name).dump() + ": ";
+        if (node.Children.empty()) {
+            contents += *node.Value;
+            continue;
+        }
+        if (node.Value.has_value()) {
+            throw std::runtime_error("\"" + name + "\" is both a value and an object");
+        }
+
+        // Like unflatten, keys below a top-level key form an array when the first of them is "0"
+        if (node.Children.begin()->first == "0") {
+            std::vector<const std::string*> elements;
+            for (const auto& [index, serialized] : node.Children) {
+                if (index.find_first_not_of("0123456789") != std::string::npos || (index.size() > 1 && index[0] == '0')) {
+                    throw std::runtime_error("\"" + index + "\" is not an array index of \"" + name + "\"");
+                }
+                const size_t i = std::stoul(index);
+                if (i >= elements.size()) {
+                    elements.resize(i + 1, nullptr);
+                }
+                elements[i] = &serialized;
+            }
+            contents += "[\n";
+            for (size_t i = 0; i < elements.size(); i++) {
+                contents += i == 0 ? "        " : ",\n        ";
+                contents += elements[i] != nullptr ? *elements[i] : "null";
+            }
+            contents += "\n    ]";
+        } else {
+            contents += "{\n";
+            for (auto child = node.Children.begin(); child != node.Children.end(); ++child) {
+                contents += child == node.Children.begin() ? "        " : ",\n        ";
+                contents += nlohmann::json(child->first).dump() + ": " + child->second;
+            }
+            contents += "\n    }";
+        }
+    }
+    contents += "\n}";
+    return contents;
+}
+
+void Config::Write(const SaveRequest& request) {
+    std::string contents;
+    try {
+        contents = Serialize(request);
+    } catch (const std::exception& e) {
+        SPDLOG_ERROR("Failed to serialize config file {}: {}", mPath, e.what());
+        // The cached blocks may be half updated, start over from a full snapshot on the next save
+        mSerializedTree.clear();
+        mSaveResync = true;
+        return;
+    }
+    const std::string tempPath = mPath + ".tmp";
+
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr) {
+        SPDLOG_ERROR("Failed to open {} to save the config", tempPath);
+        return;
+    }
+    bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size() && fflush(file) == 0;
+    // Make sure the data is on disk before the rename makes it the config file
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = fclose(file) == 0 && written;
+
+    std::error_code ec;
+    if (!written) {
+        SPDLOG_ERROR("Failed to write config file {}", tempPath);
+        fs::remove(tempPath, ec);
+        return;
+    }
+    // Replaces the old file in one step, readers see either the old or the new config
+    fs::rename(tempPath, mPath, ec);
+    if (ec) {
+        SPDLOG_ERROR("Failed to replace config file {}: {}", mPath, ec.message());
+        fs::remove(tempPath, ec);
+    }
 }
 
 template <typename T> std::vector<T> Config::GetArray(const std::string& key) {
@@ -225,10 +523,16 @@ template <typename T> std::vector<T> Config::GetArray(const std::string& key) {
 };
 
 template <typename T> void Config::SetArray(const std::string& key, std::vector<T> array) {
-    mFlattenedJson[FormatNestedKey(key)] = nlohmann::json(array);
+    const std::string flattenedKey = FormatNestedKey(key);
+    mFlattenedJson[flattenedKey] = nlohmann::json(array);
+    MarkDirty(flattenedKey);
 }
 
 nlohmann::json Config::GetNestedJson() {
+    if (mNestedJsonStale) {
+        mNestedJson = mFlattenedJson.unflatten();
+        mNestedJsonStale = false;
+    }
     return mNestedJson;
 }
 
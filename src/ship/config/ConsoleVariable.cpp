@@ -1,6 +1,10 @@
 #include "ship/config/ConsoleVariable.h"
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <mutex>
+#include <type_traits>
 #include "ship/utils/filesystemtools/DiskFile.h"
 #include "ship/utils/Utils.h"
 #include "ship/config/Config.h"
@@ -12,7 +16,10 @@
 
 namespace Ship {
 
-ConsoleVariable::ConsoleVariable() {
+ConsoleVariable::ConsoleVariable() : ConsoleVariable(Context::GetInstance()->GetConfig()) {
+}
+
+ConsoleVariable::ConsoleVariable(std::shared_ptr<Config> config) : mConfig(std::move(config)) {
     Load();
 }
 
@@ -21,13 +28,12 @@ ConsoleVariable::~ConsoleVariable() {
 }
 
 std::shared_ptr<CVar> ConsoleVariable::Get(const char* name) {
+    std::shared_lock lock(mMutex);
     auto it = mVariables.find(name);
     return it != mVariables.end() ? it->second : nullptr;
 }
 
-int32_t ConsoleVariable::GetInteger(const char* name, int32_t defaultValue) {
-    auto variable = Get(name);
-
+static int32_t ValueOf(const CVar* variable, int32_t defaultValue) {
     if (variable != nullptr && variable->Type == ConsoleVariableType::Integer) {
         return variable->Integer;
     }
@@ -35,9 +41,7 @@ int32_t ConsoleVariable::GetInteger(const char* name, int32_t defaultValue) {
     return defaultValue;
 }
 
-float ConsoleVariable::GetFloat(const char* name, float defaultValue) {
-    auto variable = Get(name);
-
+static float ValueOf(const CVar* variable, float defaultValue) {
     if (variable != nullptr && variable->Type == ConsoleVariableType::Float) {
         return variable->Float;
     }
@@ -45,9 +49,7 @@ float ConsoleVariable::GetFloat(const char* name, float defaultValue) {
     return defaultValue;
 }
 
-const char* ConsoleVariable::GetString(const char* name, const char* defaultValue) {
-    auto variable = Get(name);
-
+static const char* ValueOf(const CVar* variable, const char* defaultValue) {
     if (variable != nullptr && variable->Type == ConsoleVariableType::String) {
         return variable->String;
     }
@@ -55,9 +57,7 @@ const char* ConsoleVariable::GetString(const char* name, const char* defaultValu
     return defaultValue;
 }
 
-Color_RGBA8 ConsoleVariable::GetColor(const char* name, Color_RGBA8 defaultValue) {
-    auto variable = Get(name);
-
+static Color_RGBA8 ValueOf(const CVar* variable, Color_RGBA8 defaultValue) {
     if (variable != nullptr && variable->Type == ConsoleVariableType::Color) {
         return variable->Color;
     } else if (variable != nullptr && variable->Type == ConsoleVariableType::Color24) {
@@ -72,9 +72,7 @@ Color_RGBA8 ConsoleVariable::GetColor(const char* name, Color_RGBA8 defaultValue
     return defaultValue;
 }
 
-Color_RGB8 ConsoleVariable::GetColor24(const char* name, Color_RGB8 defaultValue) {
-    auto variable = Get(name);
-
+static Color_RGB8 ValueOf(const CVar* variable, Color_RGB8 defaultValue) {
     if (variable != nullptr && variable->Type == ConsoleVariableType::Color24) {
         return variable->Color24;
     } else if (variable != nullptr && variable->Type == ConsoleVariableType::Color) {
@@ -88,206 +86,469 @@ Color_RGB8 ConsoleVariable::GetColor24(const char* name, Color_RGB8 defaultValue
     return defaultValue;
 }
 
-void ConsoleVariable::SetInteger(const char* name, int32_t value) {
-    auto& variable = mVariables[name];
-    if (variable == nullptr) {
-        variable = std::make_shared<CVar>();
-    }
+template <typename T> T ConsoleVariable::GetValue(const char* name, T defaultValue) {
+    // Values are changed in place, so they are read under the lock rather than through Get()
+    std::shared_lock lock(mMutex);
+    auto it = mVariables.find(name);
+    return ValueOf(it != mVariables.end() ? it->second.get() : nullptr, defaultValue);
+}
 
-    variable->Type = ConsoleVariableType::Integer;
-    variable->Integer = value;
+int32_t ConsoleVariable::GetInteger(const char* name, int32_t defaultValue) {
+    return GetValue(name, defaultValue);
 }
 
-void ConsoleVariable::SetFloat(const char* name, float value) {
-    auto& variable = mVariables[name];
-    if (variable == nullptr) {
-        variable = std::make_shared<CVar>();
-    }
+float ConsoleVariable::GetFloat(const char* name, float defaultValue) {
+    return GetValue(name, defaultValue);
+}
 
-    variable->Type = ConsoleVariableType::Float;
-    variable->Float = value;
+const char* ConsoleVariable::GetString(const char* name, const char* defaultValue) {
+    return GetValue(name, defaultValue);
 }
 
-void ConsoleVariable::SetString(const char* name, const char* value) {
+Color_RGBA8 ConsoleVariable::GetColor(const char* name, Color_RGBA8 defaultValue) {
+    return GetValue(name, defaultValue);
+}
+
+Color_RGB8 ConsoleVariable::GetColor24(const char* name, Color_RGB8 defaultValue) {
+    return GetValue(name, defaultValue);
+}
+
+std::shared_ptr<CVar>& ConsoleVariable::Emplace(const char* name, bool& created) {
     auto& variable = mVariables[name];
-    if (variable == nullptr) {
+    created = variable == nullptr;
+    if (created) {
         variable = std::make_shared<CVar>();
+        mGeneration++;
     }
 
-    variable->Type = ConsoleVariableType::String;
-    if (variable->String != nullptr) {
-        free(variable->String);
+    return variable;
+}
+
+// Frees the string of a CVar that is about to hold another value
+static void ReleaseString(CVar& variable) {
+    if (variable.Type == ConsoleVariableType::String && variable.String != nullptr) {
+        free(variable.String);
+        variable.String = nullptr;
     }
-    variable->String = strdup(value);
 }
 
-void ConsoleVariable::SetColor(const char* name, Color_RGBA8 value) {
-    auto& variable = mVariables[name];
-    if (!variable) {
-        variable = std::make_shared<CVar>();
+// Copies the value of a CVar, duplicating its string
+static void CopyValue(CVar& to, const CVar& from) {
+    ReleaseString(to);
+    to.Type = from.Type;
+    switch (to.Type) {
+        case ConsoleVariableType::Integer:
+            to.Integer = from.Integer;
+            break;
+        case ConsoleVariableType::Float:
+            to.Float = from.Float;
+            break;
+        case ConsoleVariableType::String:
+            to.String = from.String != nullptr ? strdup(from.String) : nullptr;
+            break;
+        case ConsoleVariableType::Color:
+            to.Color = from.Color;
+            break;
+        case ConsoleVariableType::Color24:
+            to.Color24 = from.Color24;
+            break;
     }
+}
 
-    variable->Type = ConsoleVariableType::Color;
-    variable->Color = value;
+// Callbacks run unlocked, so they get a copy that later changes cannot free or tear
+static std::unique_ptr<CVar> CopyOf(const CVar& variable) {
+    auto copy = std::make_unique<CVar>();
+    CopyValue(*copy, variable);
+    return copy;
 }
 
-void ConsoleVariable::SetColor24(const char* name, Color_RGB8 value) {
-    auto& variable = mVariables[name];
-    if (!variable) {
-        variable = std::make_shared<CVar>();
+// Assigners for Update(), each returns whether the CVar changed
+static auto AssignInteger(int32_t value) {
+    return [value](CVar& variable, bool created) {
+        if (!created && variable.Type == ConsoleVariableType::Integer && variable.Integer == value) {
+            return false;
+        }
+
+        ReleaseString(variable);
+        variable.Type = ConsoleVariableType::Integer;
+        variable.Integer = value;
+        return true;
+    };
+}
+
+static auto AssignFloat(float value) {
+    return [value](CVar& variable, bool created) {
+        if (!created && variable.Type == ConsoleVariableType::Float && variable.Float == value) {
+            return false;
+        }
+
+        ReleaseString(variable);
+        variable.Type = ConsoleVariableType::Float;
+        variable.Float = value;
+        return true;
+    };
+}
+
+static auto AssignString(const char* value) {
+    return [value](CVar& variable, bool created) {
+        if (!created && variable.Type == ConsoleVariableType::String && variable.String != nullptr &&
+            strcmp(variable.String, value) == 0) {
+            return false;
+        }
+
+        ReleaseString(variable);
+        variable.Type = ConsoleVariableType::String;
+        variable.String = strdup(value);
+        return true;
+    };
+}
+
+static auto AssignColor(Color_RGBA8 value) {
+    return [value](CVar& variable, bool created) {
+        if (!created && variable.Type == ConsoleVariableType::Color && variable.Color.r == value.r &&
+            variable.Color.g == value.g && variable.Color.b == value.b && variable.Color.a == value.a) {
+            return false;
+        }
+
+        ReleaseString(variable);
+        variable.Type = ConsoleVariableType::Color;
+        variable.Color = value;
+        return true;
+    };
+}
+
+static auto AssignColor24(Color_RGB8 value) {
+    return [value](CVar& variable, bool created) {
+        if (!created && variable.Type == ConsoleVariableType::Color24 && variable.Color24.r == value.r &&
+            variable.Color24.g == value.g && variable.Color24.b == value.b) {
+            return false;
+        }
+
+        ReleaseString(variable);
+        variable.Type = ConsoleVariableType::Color24;
+        variable.Color24 = value;
+        return true;
+    };
+}
+
+template <typename Assign> void ConsoleVariable::Update(const char* name, bool onlyIfAbsent, Assign assign) {
+    std::vector<ChangeCallback> callbacks;
+    std::unique_ptr<CVar> snapshot;
+    {
+        std::unique_lock lock(mMutex);
+        if (onlyIfAbsent && mVariables.find(name) != mVariables.end()) {
+            return;
+        }
+
+        bool created;
+        auto& variable = Emplace(name, created);
+        if (!assign(*variable, created)) {
+            return;
+        }
+        MarkChanged(name);
+        callbacks = GetChangeCallbacks(name);
+        if (!callbacks.empty()) {
+            snapshot = CopyOf(*variable);
+        }
     }
 
-    variable->Type = ConsoleVariableType::Color24;
-    variable->Color24 = value;
+    FireChangeCallbacks(name, callbacks, snapshot.get());
+}
+
+void ConsoleVariable::SetInteger(const char* name, int32_t value) {
+    Update(name, false, AssignInteger(value));
+}
+
+void ConsoleVariable::SetFloat(const char* name, float value) {
+    Update(name, false, AssignFloat(value));
+}
+
+void ConsoleVariable::SetString(const char* name, const char* value) {
+    Update(name, false, AssignString(value));
+}
+
+void ConsoleVariable::SetColor(const char* name, Color_RGBA8 value) {
+    Update(name, false, AssignColor(value));
+}
+
+void ConsoleVariable::SetColor24(const char* name, Color_RGB8 value) {
+    Update(name, false, AssignColor24(value));
 }
 
 void ConsoleVariable::RegisterInteger(const char* name, int32_t defaultValue) {
-    if (Get(name) == nullptr) {
-        SetInteger(name, defaultValue);
-    }
+    Update(name, true, AssignInteger(defaultValue));
 }
 
 void ConsoleVariable::RegisterFloat(const char* name, float defaultValue) {
-    if (Get(name) == nullptr) {
-        SetFloat(name, defaultValue);
-    }
+    Update(name, true, AssignFloat(defaultValue));
 }
 
 void ConsoleVariable::RegisterString(const char* name, const char* defaultValue) {
-    if (Get(name) == nullptr) {
-        SetString(name, defaultValue);
-    }
+    Update(name, true, AssignString(defaultValue));
 }
 
 void ConsoleVariable::RegisterColor(const char* name, Color_RGBA8 defaultValue) {
-    if (Get(name) == nullptr) {
-        SetColor(name, defaultValue);
-    }
+    Update(name, true, AssignColor(defaultValue));
 }
 
 void ConsoleVariable::RegisterColor24(const char* name, Color_RGB8 defaultValue) {
-    if (Get(name) == nullptr) {
-        SetColor24(name, defaultValue);
-    }
+    Update(name, true, AssignColor24(defaultValue));
 }
 
 void ConsoleVariable::ClearVariable(const char* name) {
-    std::shared_ptr<Config> conf = Context::GetInstance()->GetConfig();
-    auto var = Get(name);
-    if (var != nullptr) {
-        bool color = var->Type == ConsoleVariableType::Color || var->Type == ConsoleVariableType::Color24;
-        if (color) {
-            std::string a = StringHelper::Sprintf("%s.%s", name, "A");
-            std::string b = StringHelper::Sprintf("%s.%s", name, "B");
-            std::string g = StringHelper::Sprintf("%s.%s", name, "G");
-            std::string r = StringHelper::Sprintf("%s.%s", name, "R");
-            std::string t = StringHelper::Sprintf("%s.%s", name, "Type");
-            mVariables.erase(a);
-            mVariables.erase(b);
-            mVariables.erase(g);
-            mVariables.erase(r);
-            mVariables.erase(t);
-            conf->Erase(std::string("CVars.") + a);
-            conf->Erase(std::string("CVars.") + b);
-            conf->Erase(std::string("CVars.") + g);
-            conf->Erase(std::string("CVars.") + r);
-            conf->Erase(std::string("CVars.") + t);
-        } else if (var->Type == ConsoleVariableType::String) {
-            free(var->String);
-            var->String = nullptr;
+    std::vector<ChangeCallback> callbacks;
+    {
+        std::unique_lock lock(mMutex);
+        auto it = mVariables.find(name);
+        if (it != mVariables.end()) {
+            auto& var = it->second;
+            bool color = var->Type == ConsoleVariableType::Color || var->Type == ConsoleVariableType::Color24;
+            if (color) {
+                std::string a = StringHelper::Sprintf("%s.%s", name, "A");
+                std::string b = StringHelper::Sprintf("%s.%s", name, "B");
+                std::string g = StringHelper::Sprintf("%s.%s", name, "G");
+                std::string r = StringHelper::Sprintf("%s.%s", name, "R");
+                std::string t = StringHelper::Sprintf("%s.%s", name, "Type");
+                mVariables.erase(a);
+                mVariables.erase(b);
+                mVariables.erase(g);
+                mVariables.erase(r);
+                mVariables.erase(t);
+                mConfig->Erase(std::string("CVars.") + a);
+                mConfig->Erase(std::string("CVars.") + b);
+                mConfig->Erase(std::string("CVars.") + g);
+                mConfig->Erase(std::string("CVars.") + r);
+                mConfig->Erase(std::string("CVars.") + t);
+            } else if (var->Type == ConsoleVariableType::String) {
+                free(var->String);
+                var->String = nullptr;
+            }
         }
+        mVariables.erase(name);
+        mGeneration++;
+        mConfig->Erase(StringHelper::Sprintf("CVars.%s", name));
+        MarkChanged(name);
+        callbacks = GetChangeCallbacks(name);
     }
-    mVariables.erase(name);
-    conf->Erase(StringHelper::Sprintf("CVars.%s", name));
+
+    FireChangeCallbacks(name, callbacks, nullptr);
 }
 
 void ConsoleVariable::ClearBlock(const char* name) {
-    std::shared_ptr<Config> conf = Context::GetInstance()->GetConfig();
-    conf->EraseBlock(StringHelper::Sprintf("CVars.%s", name));
+    mConfig->EraseBlock(StringHelper::Sprintf("CVars.%s", name));
     Load();
 }
 
 void ConsoleVariable::CopyVariable(const char* from, const char* to) {
-    auto& variableFrom = mVariables[from];
-    if (!variableFrom) {
-        return;
-    }
-    auto& variableTo = mVariables[to];
-    if (!variableTo) {
-        variableTo = std::make_shared<CVar>();
+    std::vector<ChangeCallback> callbacks;
+    std::unique_ptr<CVar> snapshot;
+    {
+        std::unique_lock lock(mMutex);
+        auto it = mVariables.find(from);
+        if (it == mVariables.end()) {
+            return;
+        }
+        // Held by value, emplacing the destination can rehash the map
+        const auto variableFrom = it->second;
+        bool created;
+        auto& variableTo = Emplace(to, created);
+        if (variableTo == variableFrom) {
+            return;
+        }
+        CopyValue(*variableTo, *variableFrom);
+        MarkChanged(to);
+        callbacks = GetChangeCallbacks(to);
+        if (!callbacks.empty()) {
+            snapshot = CopyOf(*variableTo);
+        }
     }
 
-    variableTo->Type = variableFrom->Type;
-    switch (variableTo->Type) {
-        case ConsoleVariableType::Integer:
-            variableTo->Integer = variableFrom->Integer;
-            break;
-        case ConsoleVariableType::Float:
-            variableTo->Float = variableFrom->Float;
-            break;
-        case ConsoleVariableType::String:
-            if (variableTo->String != nullptr) {
-                free(variableTo->String);
-            }
-            variableTo->String = strdup(variableFrom->String);
-            break;
-        case ConsoleVariableType::Color:
-            variableTo->Color = variableFrom->Color;
-            break;
-        case ConsoleVariableType::Color24:
-            variableTo->Color24 = variableFrom->Color24;
-            break;
-    }
+    FireChangeCallbacks(to, callbacks, snapshot.get());
 }
 
 void ConsoleVariable::Save() {
-    std::shared_ptr<Config> conf = Context::GetInstance()->GetConfig();
-
-    for (const auto& variable : mVariables) {
+    std::unique_lock lock(mMutex);
+    for (const auto& name : mDirtyVariables) {
+        const auto it = mVariables.find(name);
+        if (it == mVariables.end()) {
+            continue;
+        }
+        const auto& variable = *it;
         const std::string key = StringHelper::Sprintf("CVars.%s", variable.first.c_str());
 
         if (variable.second->Type == ConsoleVariableType::String && variable.second != nullptr) {
-            conf->SetString(key, variable.second->String);
+            mConfig->SetString(key, variable.second->String);
         } else if (variable.second->Type == ConsoleVariableType::Integer) {
-            conf->SetInt(key, variable.second->Integer);
+            mConfig->SetInt(key, variable.second->Integer);
         } else if (variable.second->Type == ConsoleVariableType::Float) {
-            conf->SetFloat(key, variable.second->Float);
+            mConfig->SetFloat(key, variable.second->Float);
         } else if (variable.second->Type == ConsoleVariableType::Color ||
                    variable.second->Type == ConsoleVariableType::Color24) {
             auto keyStr = key.c_str();
-            conf->SetUInt(StringHelper::Sprintf("%s.R", keyStr), variable.second->Type == ConsoleVariableType::Color
+            mConfig->SetUInt(StringHelper::Sprintf("%s.R", keyStr), variable.second->Type == ConsoleVariableType::Color
                                                                      ? variable.second->Color.r
                                                                      : variable.second->Color24.r);
-            conf->SetUInt(StringHelper::Sprintf("%s.G", keyStr), variable.second->Type == ConsoleVariableType::Color
+            mConfig->SetUInt(StringHelper::Sprintf("%s.G", keyStr), variable.second->Type == ConsoleVariableType::Color
                                                                      ? variable.second->Color.g
                                                                      : variable.second->Color24.g);
-            conf->SetUInt(StringHelper::Sprintf("%s.B", keyStr), variable.second->Type == ConsoleVariableType::Color
+            mConfig->SetUInt(StringHelper::Sprintf("%s.B", keyStr), variable.second->Type == ConsoleVariableType::Color
                                                                      ? variable.second->Color.b
                                                                      : variable.second->Color24.b);
             if (variable.second->Type == ConsoleVariableType::Color) {
-                conf->SetUInt(StringHelper::Sprintf("%s.A", keyStr), variable.second->Color.a);
-                conf->SetString(StringHelper::Sprintf("%s.Type", keyStr), "RGBA");
+                mConfig->SetUInt(StringHelper::Sprintf("%s.A", keyStr), variable.second->Color.a);
+                mConfig->SetString(StringHelper::Sprintf("%s.Type", keyStr), "RGBA");
             } else {
-                conf->SetString(StringHelper::Sprintf("%s.Type", keyStr), "RGB");
+                mConfig->SetString(StringHelper::Sprintf("%s.Type", keyStr), "RGB");
             }
         }
     }
+    mDirtyVariables.clear();
+    lock.unlock();
 
-    conf->Save();
+    mConfig->Save();
 }
 
 void ConsoleVariable::Load() {
-    std::shared_ptr<Config> conf = Context::GetInstance()->GetConfig();
-    conf->Reload();
-    if (!mVariables.empty()) {
-        mVariables.clear();
+    mConfig->Reload();
+    std::vector<std::string> previous;
+    {
+        std::unique_lock lock(mMutex);
+        if (!mVariables.empty()) {
+            previous.reserve(mVariables.size());
+            for (const auto& [name, variable] : mVariables) {
+                previous.push_back(name);
+            }
+            mVariables.clear();
+            mGeneration++;
+            mChangeSequence++;
+        }
     }
 
-    LoadFromPath("", conf->GetNestedJson()["CVars"].items());
+    LoadFromPath("", mConfig->GetNestedJson()["CVars"].items());
+    {
+        // Values from the legacy file are not in the config yet and stay dirty
+        std::unique_lock lock(mMutex);
+        mDirtyVariables.clear();
+    }
 
     LoadLegacy();
+
+    // CVars that were only in memory are gone now, their callbacks see them cleared
+    for (const auto& name : previous) {
+        std::vector<ChangeCallback> callbacks;
+        {
+            std::unique_lock lock(mMutex);
+            if (mVariables.contains(name)) {
+                continue;
+            }
+            mChangeSequence++;
+            callbacks = GetChangeCallbacks(name.c_str());
+        }
+        FireChangeCallbacks(name.c_str(), callbacks, nullptr);
+    }
+}
+
+uint64_t ConsoleVariable::GetGeneration() const {
+    return mGeneration.load(std::memory_order_relaxed);
+}
+
+uint32_t ConsoleVariable::RegisterChangeCallback(const char* name, CVarChangedCallback callback) {
+    std::unique_lock lock(mMutex);
+    const uint32_t id = mNextChangeCallbackId++;
+    auto it = mChangeCallbacks.find(std::string_view(name));
+    if (it == mChangeCallbacks.end()) {
+        it = mChangeCallbacks.emplace(name, std::vector<ChangeCallback>()).first;
+    }
+    it->second.push_back({ id, std::make_shared<CVarChangedCallback>(std::move(callback)) });
+    return id;
+}
+
+void ConsoleVariable::UnregisterChangeCallback(uint32_t id) {
+    std::unique_lock lock(mMutex);
+    for (auto it = mChangeCallbacks.begin(); it != mChangeCallbacks.end(); ++it) {
+        auto& callbacks = it->second;
+        auto callback = std::find_if(callbacks.begin(), callbacks.end(),
+                                     [id](const ChangeCallback& callback) { return callback.Id == id; });
+        if (callback != callbacks.end()) {
+            callbacks.erase(callback);
+            if (callbacks.empty()) {
+                mChangeCallbacks.erase(it);
+            }
+            return;
+        }
+    }
+}
+
+uint64_t ConsoleVariable::GetChangeSequence() const {
+    return mChangeSequence.load(std::memory_order_relaxed);
+}
+
+void ConsoleVariable::MarkChanged(const char* name) {
+    mChangeSequence++;
+    mDirtyVariables.emplace(name);
+}
+
+std::vector<ConsoleVariable::ChangeCallback> ConsoleVariable::GetChangeCallbacks(const char* name) const {
+    auto it = mChangeCallbacks.find(std::string_view(name));
+    return it != mChangeCallbacks.end() ? it->second : std::vector<ChangeCallback>();
+}
+
+void ConsoleVariable::FireChangeCallbacks(const char* name, const std::vector<ChangeCallback>& callbacks,
+                                          const CVar* variable) {
+    // Callbacks may set other CVars or (un)register callbacks, so they run from a copy outside the lock
+    for (const auto& callback : callbacks) {
+        (*callback.Callback)(name, variable);
+    }
+}
+
+template <typename T>
+CVarHandle<T>::CVarHandle(const char* name, T defaultValue) : mName(name), mDefaultValue(defaultValue) {
 }
 
+template <typename T> T CVarHandle<T>::Get() {
+    ConsoleVariable* consoleVariables = mConsoleVariables.load(std::memory_order_acquire);
+    if (consoleVariables == nullptr) {
+        auto context = Context::GetInstance();
+        if (context == nullptr || context->GetConsoleVariables() == nullptr) {
+            return mDefaultValue;
+        }
+        consoleVariables = context->GetConsoleVariables().get();
+        mConsoleVariables.store(consoleVariables, std::memory_order_release);
+    }
+
+    if constexpr (std::is_same_v<T, std::string>) {
+        std::shared_lock lock(consoleVariables->mMutex);
+        auto it = consoleVariables->mVariables.find(mName);
+        return ValueOf(it != consoleVariables->mVariables.end() ? it->second.get() : nullptr, mDefaultValue.c_str());
+    } else {
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint32_t));
+        T value;
+        const uint64_t sequence = consoleVariables->mChangeSequence.load(std::memory_order_acquire);
+        if (mSequence.load(std::memory_order_acquire) == sequence) {
+            const uint32_t bits = mValue.load(std::memory_order_relaxed);
+            memcpy(&value, &bits, sizeof(T));
+            return value;
+        }
+
+        // The sequence only advances under the exclusive lock, so every reader refreshing at the same time stores the
+        // same value and sequence
+        std::shared_lock lock(consoleVariables->mMutex);
+        auto it = consoleVariables->mVariables.find(mName);
+        value = ValueOf(it != consoleVariables->mVariables.end() ? it->second.get() : nullptr, mDefaultValue);
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(T));
+        mValue.store(bits, std::memory_order_relaxed);
+        mSequence.store(consoleVariables->mChangeSequence.load(std::memory_order_relaxed), std::memory_order_release);
+        return value;
+    }
+}
+
+template class CVarHandle<int32_t>;
+template class CVarHandle<float>;
+template class CVarHandle<std::string>;
+template class CVarHandle<Color_RGBA8>;
+template class CVarHandle<Color_RGB8>;
+
 void ConsoleVariable::LoadFromPath(
     std::string path, nlohmann::detail::iteration_proxy<nlohmann::detail::iter_impl<nlohmann::json>> items) {
     if (!path.empty()) {
@@ -3,6 +3,8 @@
 #include "ship/resource/File.h"
 #include "ship/resource/archive/Archive.h"
 #include <algorithm>
+#include <chrono>
+#include <numeric>
 #include <thread>
 #include "ship/utils/StringHelper.h"
 #include "ship/utils/Utils.h"
@@ -47,6 +49,76 @@ size_t ResourceIdentifierHash::operator()(const ResourceIdentifier& rcd) const {
     return rcd.GetHash();
 }
 
+ResourceLoadBatch::ResourceLoadBatch(std::vector<std::string>&& files)
+    : mFiles(std::move(files)), mPromises(mFiles.size()),
+      mResources(std::make_shared<std::vector<std::shared_ptr<IResource>>>(mFiles.size())) {
+    mFutures.reserve(mPromises.size());
+    for (auto& promise : mPromises) {
+        mFutures.push_back(promise.get_future().share());
+    }
+    mDoneFuture = mDone.get_future().share();
+    if (mFiles.empty()) {
+        mDone.set_value(mResources);
+    }
+}
+
+const std::vector<std::string>& ResourceLoadBatch::GetFiles() const {
+    return mFiles;
+}
+
+size_t ResourceLoadBatch::GetFileCount() const {
+    return mFiles.size();
+}
+
+size_t ResourceLoadBatch::GetLoadedCount() const {
+    return mLoaded;
+}
+
+float ResourceLoadBatch::GetProgress() const {
+    return mFiles.empty() ? 1.0f : (float)mLoaded / (float)mFiles.size();
+}
+
+bool ResourceLoadBatch::IsDone() const {
+    return mLoaded == mFiles.size();
+}
+
+std::shared_future<std::shared_ptr<IResource>> ResourceLoadBatch::GetResource(size_t index) const {
+    return mFutures.at(index);
+}
+
+std::shared_future<std::shared_ptr<std::vector<std::shared_ptr<IResource>>>> ResourceLoadBatch::GetFuture() const {
+    return mDoneFuture;
+}
+
+void ResourceLoadBatch::Wait() const {
+    mDoneFuture.wait();
+}
+
+void ResourceLoadBatch::Finish(size_t index, std::shared_ptr<IResource> resource, std::exception_ptr error) {
+    if (error != nullptr) {
+        mPromises[index].set_exception(error);
+        const std::lock_guard<std::mutex> lock(mErrorMutex);
+        if (mError == nullptr) {
+            mError = error;
+        }
+    } else {
+        (*mResources)[index] = resource;
+        mPromises[index].set_value(std::move(resource));
+    }
+
+    // The last file to finish sees every other file's result through this counter
+    if (mLoaded.fetch_add(1, std::memory_order_acq_rel) + 1 != mFiles.size()) {
+        return;
+    }
+
+    // The first failure is rethrown by the batch future, like a failure of the single task loading the batch used to
+    if (mError != nullptr) {
+        mDone.set_exception(mError);
+    } else {
+        mDone.set_value(mResources);
+    }
+}
+
 ResourceManager::ResourceManager() {
 }
 
@@ -108,18 +180,22 @@ std::shared_ptr<IResource> ResourceManager::LoadResourceProcess(const ResourceId
 
     // Cache the starts_with check to avoid repeated string comparisons
     const bool isAltPath = identifier.Path.starts_with(IResource::gAltAssetPrefix);
-    const bool shouldCheckAlt = !loadExact && mAltAssetsEnabled && !isAltPath;
+    const bool shouldCheckAlt = !loadExact && mAltAssetsEnabled && !isAltPath && mArchiveManager->HasAltAssets();
 
     // Attempt to load the alternate version of the asset, if we fail then we continue trying to load the standard
     // asset.
     if (shouldCheckAlt) {
         std::string altPath = IResource::gAltAssetPrefix;
         altPath += identifier.Path;
-        auto altResource =
-            LoadResourceProcess({ std::move(altPath), identifier.Owner, identifier.Parent }, loadExact, initData);
-
-        if (altResource != nullptr) {
-            return altResource;
+        // Most assets have no alt version. Those misses are answered by the archive index, without going through the
+        // loader or leaving a NotFound entry in the cache.
+        if (mArchiveManager->HasFile(altPath)) {
+            auto altResource =
+                LoadResourceProcess({ std::move(altPath), identifier.Owner, identifier.Parent }, loadExact, initData);
+
+            if (altResource != nullptr) {
+                return altResource;
+            }
         }
     }
 
@@ -149,37 +225,60 @@ std::shared_ptr<IResource> ResourceManager::LoadResourceProcess(const ResourceId
         }
     }
 
+    // Another thread may be loading this resource right now. Wait for it instead of reading and decoding it twice.
+    std::promise<std::shared_ptr<IResource>> loaded;
+    const bool onPool = BS::this_thread::get_pool() == mThreadPool.get();
+    {
+        std::unique_lock<std::mutex> lock(mLoadsInFlightMutex);
+        auto loadFind = mLoadsInFlight.find(identifier);
+        if (loadFind != mLoadsInFlight.end()) {
+            // A resource that loads itself on the same thread would wait forever, so it is loaded again instead. So is
+            // one a pool thread would wait for on another thread, that thread may queue its dependencies on the pool
+            // and wait for them while every pool thread is waiting for it.
+            if (loadFind->second.Thread == std::this_thread::get_id() || (onPool && !loadFind->second.OnPool)) {
+                lock.unlock();
+                return LoadAndCacheResource(identifier, initData);
+            }
+
+            auto pending = loadFind->second.Result;
+            lock.unlock();
+            return pending.get();
+        }
+        mLoadsInFlight.emplace(identifier,
+                               LoadInFlight{ loaded.get_future().share(), std::this_thread::get_id(), onPool });
+    }
+
+    std::shared_ptr<IResource> resource;
+    try {
+        // The previous load may have finished between the cache check above and registering this one
+        resource = GetCachedResource(identifier, true);
+        if (resource == nullptr) {
+            resource = LoadAndCacheResource(identifier, initData);
+        }
+    } catch (...) {
+        loaded.set_exception(std::current_exception());
+        EndLoadInFlight(identifier);
+        throw;
+    }
+
+    loaded.set_value(resource);
+    EndLoadInFlight(identifier);
+    return resource;
+}
+
+std::shared_ptr<IResource> ResourceManager::LoadAndCacheResource(const ResourceIdentifier& identifier,
+                                                                 std::shared_ptr<ResourceInitData> initData) {
     // Get the file from the OTR
     auto file = LoadFileProcess(identifier.Path);
     if (file == nullptr) {
         SPDLOG_TRACE("Failed to load resource file at path {}", identifier.Path);
-        mResourceCache[identifier] = ResourceLoadError::NotFound;
+        CacheResource(identifier, nullptr);
         return nullptr;
     }
 
     // Transform the raw data into a resource
     auto resource = GetResourceLoader()->LoadResource(identifier.Path, file, initData);
-
-    // Another thread could have loaded the resource while we were processing, so we want to check before setting to
-    // the cache.
-    cachedResource = GetCachedResource(identifier, true);
-
-    {
-        const std::lock_guard<std::mutex> lock(mMutex);
-
-        if (cachedResource != nullptr) {
-            // If another thread has already loaded this resource, discard the work we already did and return from
-            // cache.
-            resource = cachedResource;
-        }
-
-        // Set the cache to the loaded resource
-        if (resource != nullptr) {
-            mResourceCache[identifier] = resource;
-        } else {
-            mResourceCache[identifier] = ResourceLoadError::NotFound;
-        }
-    }
+    resource = CacheResource(identifier, resource);
 
     if (resource != nullptr) {
         SPDLOG_TRACE("Loaded Resource {} on ResourceManager", identifier.Path);
@@ -190,6 +289,11 @@ std::shared_ptr<IResource> ResourceManager::LoadResourceProcess(const ResourceId
     return resource;
 }
 
+void ResourceManager::EndLoadInFlight(const ResourceIdentifier& identifier) {
+    const std::lock_guard<std::mutex> lock(mLoadsInFlightMutex);
+    mLoadsInFlight.erase(identifier);
+}
+
 std::shared_ptr<IResource> ResourceManager::LoadResourceProcess(const std::string& filePath, bool loadExact,
                                                                 std::shared_ptr<ResourceInitData> initData) {
     return LoadResourceProcess({ filePath, mDefaultCacheOwner, mDefaultCacheArchive }, loadExact, initData);
@@ -212,6 +316,17 @@ ResourceManager::LoadResourceAsync(const ResourceIdentifier& identifier, bool lo
         return promise->get_future().share();
     }
 
+    // Share a load that is already running rather than queueing a task that would only wait for it. Only when this
+    // request resolves to exactly that identifier, otherwise it would first look for an alt asset.
+    if (loadExact || !mAltAssetsEnabled || identifier.Path.starts_with(IResource::gAltAssetPrefix) ||
+        !mArchiveManager->HasAltAssets()) {
+        const std::lock_guard<std::mutex> lock(mLoadsInFlightMutex);
+        auto loadFind = mLoadsInFlight.find(identifier);
+        if (loadFind != mLoadsInFlight.end() && loadFind->second.Thread != std::this_thread::get_id()) {
+            return loadFind->second.Result;
+        }
+    }
+
     return mThreadPool->submit_task(
         [this, identifier, loadExact, initData]() -> std::shared_ptr<IResource> {
             return LoadResourceProcess(identifier, loadExact, initData);
@@ -227,6 +342,12 @@ ResourceManager::LoadResourceAsync(const std::string& filePath, bool loadExact,
 
 std::shared_ptr<IResource> ResourceManager::LoadResource(const ResourceIdentifier& identifier, bool loadExact,
                                                          std::shared_ptr<ResourceInitData> initData) {
+    // A pool thread, e.g. a factory of a batch loading a dependency, loads on its own. Waiting for a queued task
+    // would never end once every pool thread was waiting.
+    if (BS::this_thread::get_pool() == mThreadPool.get()) {
+        return LoadResourceProcess(identifier, loadExact, initData);
+    }
+
     auto resource = LoadResourceAsync(identifier, loadExact, BS::pr::highest, initData).get();
     if (resource == nullptr) {
         SPDLOG_TRACE("Failed to load resource file at path {}", identifier.Path);
@@ -252,25 +373,31 @@ std::shared_ptr<IResource> ResourceManager::LoadResource(uint64_t crc, bool load
 
 std::variant<ResourceManager::ResourceLoadError, std::shared_ptr<IResource>>
 ResourceManager::CheckCache(const ResourceIdentifier& identifier, bool loadExact) {
-    if (!loadExact && mAltAssetsEnabled && !identifier.Path.starts_with(IResource::gAltAssetPrefix)) {
+    if (!loadExact && mAltAssetsEnabled && !identifier.Path.starts_with(IResource::gAltAssetPrefix) &&
+        mArchiveManager->HasAltAssets()) {
         const auto altPath = IResource::gAltAssetPrefix + identifier.Path;
-        auto altCacheResult = CheckCache({ altPath, identifier.Owner, identifier.Parent }, loadExact);
+        if (mArchiveManager->HasFile(altPath)) {
+            auto altCacheResult = CheckCache({ altPath, identifier.Owner, identifier.Parent }, loadExact);
 
-        // If the type held at this cache index is a resource, then we return it.
-        // Else we attempt to load standard definition assets.
-        if (std::holds_alternative<std::shared_ptr<IResource>>(altCacheResult)) {
-            return altCacheResult;
+            // If the type held at this cache index is a resource, then we return it.
+            // Else we attempt to load standard definition assets.
+            if (std::holds_alternative<std::shared_ptr<IResource>>(altCacheResult)) {
+                return altCacheResult;
+            }
         }
     }
 
-    const std::lock_guard<std::mutex> lock(mMutex);
+    auto& shard = GetCacheShard(identifier);
+    const std::shared_lock<std::shared_mutex> lock(shard.Mutex);
 
-    auto cacheFind = mResourceCache.find(identifier);
-    if (cacheFind == mResourceCache.end()) {
+    auto cacheFind = shard.Entries.find(identifier);
+    if (cacheFind == shard.Entries.end()) {
         return ResourceLoadError::NotCached;
     }
 
-    return cacheFind->second;
+    cacheFind->second.LastUse.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                    std::memory_order_relaxed);
+    return cacheFind->second.Value;
 }
 
 std::variant<ResourceManager::ResourceLoadError, std::shared_ptr<IResource>>
@@ -313,28 +440,206 @@ ResourceManager::GetCachedResource(std::variant<ResourceLoadError, std::shared_p
     return nullptr;
 }
 
+ResourceManager::CacheShard& ResourceManager::GetCacheShard(const ResourceIdentifier& identifier) {
+    // The top bits of a multiplicative hash, the maps inside the shards bucket by the low bits
+    const uint64_t hash = (uint64_t)ResourceIdentifierHash{}(identifier) * 0x9E3779B97F4A7C15ull;
+    return mCacheShards[(hash >> 32) % CACHE_SHARD_COUNT];
+}
+
+std::shared_ptr<IResource> ResourceManager::CacheResource(const ResourceIdentifier& identifier,
+                                                          std::shared_ptr<IResource> resource) {
+    {
+        std::vector<std::shared_ptr<IResource>> released;
+        auto& shard = GetCacheShard(identifier);
+        const std::lock_guard<std::shared_mutex> lock(shard.Mutex);
+
+        // Another thread could have loaded the resource while we were processing. If so, discard the work we already
+        // did and return from cache.
+        auto cacheFind = shard.Entries.find(identifier);
+        if (cacheFind != shard.Entries.end()) {
+            auto cachedResource = GetCachedResource(cacheFind->second.Value);
+            if (cachedResource != nullptr) {
+                return cachedResource;
+            }
+        }
+
+        if (resource == nullptr) {
+            SetCacheEntry(shard, identifier, ResourceLoadError::NotFound, released);
+            return nullptr;
+        }
+        SetCacheEntry(shard, identifier, resource, released);
+    }
+
+    EvictResources();
+    return resource;
+}
+
+void ResourceManager::SetCacheEntry(CacheShard& shard, const ResourceIdentifier& identifier,
+                                    std::variant<ResourceLoadError, std::shared_ptr<IResource>> value,
+                                    std::vector<std::shared_ptr<IResource>>& released) {
+    CacheEntry& entry = shard.Entries[identifier];
+    mCachedResourcesSize -= entry.Size;
+    entry.Size = 0;
+    if (std::holds_alternative<std::shared_ptr<IResource>>(entry.Value)) {
+        released.push_back(std::move(std::get<std::shared_ptr<IResource>>(entry.Value)));
+    }
+
+    entry.Value = std::move(value);
+    entry.LastUse.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    if (std::holds_alternative<std::shared_ptr<IResource>>(entry.Value) &&
+        std::get<std::shared_ptr<IResource>>(entry.Value) != nullptr) {
+        entry.Size = std::get<std::shared_ptr<IResource>>(entry.Value)->GetPointerSize();
+        mCachedResourcesSize += entry.Size;
+    }
+}
+
+size_t ResourceManager::EraseCacheEntry(CacheShard& shard, const ResourceIdentifier& identifier,
+                                        std::vector<std::shared_ptr<IResource>>& released) {
+    auto cacheFind = shard.Entries.find(identifier);
+    if (cacheFind == shard.Entries.end()) {
+        return 0;
+    }
+
+    mCachedResourcesSize -= cacheFind->second.Size;
+    if (std::holds_alternative<std::shared_ptr<IResource>>(cacheFind->second.Value)) {
+        released.push_back(std::move(std::get<std::shared_ptr<IResource>>(cacheFind->second.Value)));
+    }
+    shard.Entries.erase(cacheFind);
+    return 1;
+}
+
+void ResourceManager::EvictResources() {
+    if (mMemoryBudget == 0 || mCachedResourcesSize <= std::max<size_t>(mMemoryBudget, mEvictionRetrySize)) {
+        return;
+    }
+
+    // Destroyed after the lock is released, destroying a resource can load others and evict again
+    std::vector<std::shared_ptr<IResource>> released;
+    const std::lock_guard<std::mutex> evictionLock(mEvictionMutex);
+    const size_t budget = mMemoryBudget;
+    if (budget == 0 || mCachedResourcesSize <= std::max<size_t>(budget, mEvictionRetrySize)) {
+        return;
+    }
+
+    // Collect what could be evicted from every shard, skipping resources that are pinned, still referenced
+    // outside the cache or whose raw pointer was handed out
+    std::vector<std::pair<int64_t, ResourceIdentifier>> candidates;
+    for (auto& shard : mCacheShards) {
+        const std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+        for (const auto& [identifier, entry] : shard.Entries) {
+            if (entry.Size == 0) {
+                continue;
+            }
+            const auto& resource = std::get<std::shared_ptr<IResource>>(entry.Value);
+            if (resource.use_count() == 1 && !resource->mRawPointerShared.load(std::memory_order_relaxed) &&
+                !mPinnedResources.contains(identifier)) {
+                candidates.emplace_back(entry.LastUse.load(std::memory_order_relaxed), identifier);
+            }
+        }
+    }
+    // ResourceIdentifier can't be assigned, so the order is sorted separately
+    std::vector<size_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&candidates](size_t a, size_t b) { return candidates[a].first < candidates[b].first; });
+
+    // Evicting a little more than needed saves collecting candidates again on the next few loads
+    const size_t target = budget - budget / 16;
+    for (size_t i : order) {
+        const auto& [lastUse, identifier] = candidates[i];
+        if (mCachedResourcesSize <= target) {
+            break;
+        }
+
+        auto& shard = GetCacheShard(identifier);
+        const std::lock_guard<std::shared_mutex> lock(shard.Mutex);
+        // It may have been used since it was collected
+        auto cacheFind = shard.Entries.find(identifier);
+        if (cacheFind == shard.Entries.end() || cacheFind->second.Size == 0 ||
+            cacheFind->second.LastUse.load(std::memory_order_relaxed) != lastUse) {
+            continue;
+        }
+        const auto& resource = std::get<std::shared_ptr<IResource>>(cacheFind->second.Value);
+        if (resource.use_count() != 1 || resource->mRawPointerShared.load(std::memory_order_relaxed)) {
+            continue;
+        }
+
+        SPDLOG_TRACE("Evicting resource {} from the cache", identifier.Path);
+        EraseCacheEntry(shard, identifier, released);
+    }
+
+    // What is left is pinned or in use. Wait for the cache to grow a little before looking again, instead of
+    // visiting every resource on each load.
+    const size_t remaining = mCachedResourcesSize;
+    mEvictionRetrySize = remaining > budget ? remaining + budget / 16 : 0;
+}
+
 std::shared_ptr<std::vector<std::shared_ptr<IResource>>>
 ResourceManager::LoadResourcesProcess(const ResourceFilter& filter) {
-    auto loadedList = std::make_shared<std::vector<std::shared_ptr<IResource>>>();
+    return LoadResourcesBatch(filter, BS::pr::highest)->GetFuture().get();
+}
+
+std::shared_ptr<ResourceLoadBatch> ResourceManager::LoadResourcesBatch(const ResourceFilter& filter,
+                                                                       BS::priority_t priority) {
     auto fileList = GetArchiveManager()->ListFiles(filter.IncludeMasks, filter.ExcludeMasks);
-    loadedList->reserve(fileList->size());
+    auto batch = std::shared_ptr<ResourceLoadBatch>(new ResourceLoadBatch(std::move(*fileList)));
 
-    for (size_t i = 0; i < fileList->size(); i++) {
-        auto fileName = std::string(fileList->operator[](i));
-        auto resource = LoadResource({ fileName, filter.Owner, filter.Parent });
-        loadedList->push_back(resource);
+    // A pool thread waiting for the batch would never see it finish once every pool thread was waiting, so it
+    // loads the files itself
+    if (BS::this_thread::get_pool() == mThreadPool.get()) {
+        while (batch->mNext < batch->GetFileCount()) {
+            LoadResourcesBatchFile(batch, filter);
+        }
+        return batch;
     }
 
-    return loadedList;
+    // One task per pool thread at most, each of them queues its next file when it is done with one. That keeps
+    // every core busy without the batch holding on to the whole pool.
+    const size_t taskCount = std::min<size_t>(batch->GetFileCount(), mThreadPool->get_thread_count());
+    for (size_t i = 0; i < taskCount; i++) {
+        mThreadPool->detach_task(
+            [this, batch, filter, priority]() { LoadResourcesBatchProcess(batch, filter, priority); }, priority);
+    }
+
+    return batch;
+}
+
+std::shared_ptr<ResourceLoadBatch> ResourceManager::LoadResourcesBatch(const std::string& searchMask,
+                                                                       BS::priority_t priority) {
+    return LoadResourcesBatch({ { searchMask }, {}, mDefaultCacheOwner, mDefaultCacheArchive }, priority);
+}
+
+void ResourceManager::LoadResourcesBatchFile(std::shared_ptr<ResourceLoadBatch> batch, const ResourceFilter& filter) {
+    const size_t index = batch->mNext++;
+    if (index >= batch->GetFileCount()) {
+        return;
+    }
+
+    std::shared_ptr<IResource> resource;
+    std::exception_ptr error;
+    try {
+        // This already runs on the pool, so the load happens right here instead of in another task
+        resource = LoadResourceProcess({ batch->mFiles[index], filter.Owner, filter.Parent });
+    } catch (...) {
+        error = std::current_exception();
+    }
+    batch->Finish(index, std::move(resource), error);
+}
+
+void ResourceManager::LoadResourcesBatchProcess(std::shared_ptr<ResourceLoadBatch> batch,
+                                                const ResourceFilter& filter, BS::priority_t priority) {
+    LoadResourcesBatchFile(batch, filter);
+
+    // Queued rather than looping, so that loads with a higher priority can run in between
+    if (batch->mNext < batch->GetFileCount()) {
+        mThreadPool->detach_task(
+            [this, batch, filter, priority]() { LoadResourcesBatchProcess(batch, filter, priority); }, priority);
+    }
 }
 
 std::shared_future<std::shared_ptr<std::vector<std::shared_ptr<IResource>>>>
 ResourceManager::LoadResourcesAsync(const ResourceFilter& filter, BS::priority_t priority) {
-    return mThreadPool->submit_task(
-        [this, filter]() -> std::shared_ptr<std::vector<std::shared_ptr<IResource>>> {
-            return LoadResourcesProcess(filter);
-        },
-        priority);
+    return LoadResourcesBatch(filter, priority)->GetFuture();
 }
 
 std::shared_future<std::shared_ptr<std::vector<std::shared_ptr<IResource>>>>
@@ -406,21 +711,62 @@ size_t ResourceManager::UnloadResource(const ResourceIdentifier& identifier) {
     // Store a shared pointer here so that erase doesn't destruct the resource.
     // The resource will attempt to load other resources on the destructor, and this will fail because we already hold
     // the mutex.
-    std::variant<ResourceLoadError, std::shared_ptr<IResource>> value = nullptr;
-    size_t ret = 0;
-    // We can only erase the resource if we have any resources for that owner.
-    if (mResourceCache.contains(identifier)) {
-        const std::lock_guard<std::mutex> lock(mMutex);
-        mResourceCache.erase(identifier);
-    }
-
-    return ret;
+    std::vector<std::shared_ptr<IResource>> released;
+    auto& shard = GetCacheShard(identifier);
+    const std::lock_guard<std::shared_mutex> lock(shard.Mutex);
+    return EraseCacheEntry(shard, identifier, released);
 }
 
 size_t ResourceManager::UnloadResource(const std::string& filePath) {
     return UnloadResource({ filePath, mDefaultCacheOwner, mDefaultCacheArchive });
 }
 
+void ResourceManager::SetMemoryBudget(size_t bytes) {
+    mMemoryBudget = bytes;
+    mEvictionRetrySize = 0;
+    EvictResources();
+}
+
+size_t ResourceManager::GetMemoryBudget() {
+    return mMemoryBudget;
+}
+
+size_t ResourceManager::GetCachedResourcesSize() {
+    return mCachedResourcesSize;
+}
+
+void ResourceManager::PinResource(const ResourceIdentifier& identifier) {
+    const std::lock_guard<std::mutex> lock(mEvictionMutex);
+    mPinnedResources[identifier]++;
+}
+
+void ResourceManager::PinResource(const std::string& filePath) {
+    PinResource({ filePath, mDefaultCacheOwner, mDefaultCacheArchive });
+}
+
+bool ResourceManager::UnpinResource(const ResourceIdentifier& identifier) {
+    {
+        const std::lock_guard<std::mutex> lock(mEvictionMutex);
+        auto pinFind = mPinnedResources.find(identifier);
+        if (pinFind == mPinnedResources.end()) {
+            return false;
+        }
+
+        if (--pinFind->second != 0) {
+            return true;
+        }
+        mPinnedResources.erase(pinFind);
+        mEvictionRetrySize = 0;
+    }
+
+    EvictResources();
+    return true;
+}
+
+bool ResourceManager::UnpinResource(const std::string& filePath) {
+    return UnpinResource({ filePath, mDefaultCacheOwner, mDefaultCacheArchive });
+}
+
 bool ResourceManager::WriteResource(const ResourceIdentifier& identifier, const std::vector<uint8_t>& data,
                                     bool unloadFile) {
     std::shared_ptr<Archive> archive = identifier.Parent;
@@ -502,6 +848,10 @@ void* ResourceManager::GetResourceRawPointer(std::shared_ptr<IResource> resource
         return nullptr;
     }
 
+    // The caller keeps only the raw pointer, so the cache has to keep the resource alive
+    if (!resource->mRawPointerShared.load(std::memory_order_relaxed)) {
+        resource->mRawPointerShared.store(true, std::memory_order_relaxed);
+    }
     return resource->GetRawPointer();
 }
 
@@ -19,8 +19,133 @@
 #include <monocypher.h>
 #include <nlohmann/json.hpp>
 #include <monocypher-ed25519.h>
+#include <mutex>
+#ifdef ENABLE_SCRIPTING
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#endif
 
 namespace Ship {
+#ifdef ENABLE_SCRIPTING
+static std::mutex sKeystoreMutex;
+
+// Loaded files are hashed in path order as soon as every file before them is, so only this many are held at once
+#define CHECKSUM_WINDOW_PER_THREAD 4
+
+// Reader threads of all checksums running at once. ArchiveManager validates archives on several threads, together
+// they start no more readers than there are cores.
+static std::atomic<size_t> sChecksumThreads = 0;
+
+static std::shared_ptr<File> LoadChecksumFile(Archive& archive, const std::string& filePath) {
+    auto file = archive.LoadFile(filePath);
+    return file != nullptr && file->IsLoaded ? file : nullptr;
+}
+
+// The checksum is a single BLAKE2b over every path and its contents in path order, as written by the packing tools.
+// Loading and decompressing the files is what takes time, so that is spread over threads while this thread hashes.
+static bool ComputeChecksum(Archive& archive, std::vector<uint8_t>& rawHash) {
+    std::vector<std::pair<std::string, std::string>> paths;
+    for (const auto& [hash, filePath] : *archive.ListFiles()) {
+        std::string normalizedPath = filePath;
+        std::replace(normalizedPath.begin(), normalizedPath.end(), '\\', '/');
+
+        if (normalizedPath == "manifest.json" || normalizedPath.back() == '/') {
+            continue;
+        }
+
+        paths.emplace_back(normalizedPath, filePath);
+    }
+    std::sort(paths.begin(), paths.end());
+
+    // Without a free reader this thread loads the files itself
+    const size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t threadCount;
+    size_t running = sChecksumThreads.load();
+    do {
+        threadCount = std::min(paths.size(), maxThreads - std::min(running, maxThreads));
+    } while (threadCount > 0 && !sChecksumThreads.compare_exchange_weak(running, running + threadCount));
+    const size_t window = threadCount * CHECKSUM_WINDOW_PER_THREAD;
+    std::vector<std::shared_ptr<File>> files(paths.size());
+    std::vector<bool> done(paths.size(), false);
+    size_t next = 0;
+    size_t hashed = 0;
+    bool failed = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    auto loadNext = [&]() {
+        while (true) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return failed || next == paths.size() || next < hashed + window; });
+                if (failed || next == paths.size()) {
+                    return;
+                }
+                i = next++;
+            }
+
+            auto file = LoadChecksumFile(archive, paths[i].second);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                files[i] = std::move(file);
+                done[i] = true;
+            }
+            changed.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(loadNext);
+    }
+
+    crypto_blake2b_ctx ctx;
+    crypto_blake2b_init(&ctx, 64);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        std::shared_ptr<File> file;
+        if (threadCount == 0) {
+            file = LoadChecksumFile(archive, paths[i].second);
+            failed = file == nullptr;
+        } else {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return done[i]; });
+            file = std::move(files[i]);
+            hashed = i + 1;
+            failed = file == nullptr;
+            lock.unlock();
+            changed.notify_all();
+        }
+
+        const std::string& normalizedPath = paths[i].first;
+        if (file == nullptr) {
+            SPDLOG_ERROR("Failed to load file {} from archive {} during validation", paths[i].second,
+                         archive.GetPath());
+            break;
+        }
+
+        crypto_blake2b_update(&ctx, reinterpret_cast<const uint8_t*>(normalizedPath.c_str()), normalizedPath.length());
+        if (file->Buffer->size() > 0) {
+            crypto_blake2b_update(&ctx, reinterpret_cast<const uint8_t*>(file->Buffer->data()), file->Buffer->size());
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    sChecksumThreads -= threadCount;
+    if (failed) {
+        return false;
+    }
+
+    rawHash.resize(64);
+    crypto_blake2b_final(&ctx, rawHash.data());
+    return true;
+}
+#endif
+
 Archive::Archive(const std::string& path)
     : mIsLoaded(false), mIsSigned(false), mIsChecksumValid(false), mHasGameVersion(false), mGameVersion(0xFFFFFFFF),
       mManifest(), mPath(path) {
@@ -180,6 +305,16 @@ void Archive::IndexFile(const std::string& filePath) {
     (*mHashes)[CRC64(filePath.c_str())] = filePath;
 }
 
+void Archive::IndexFile(const std::string& filePath, uint64_t hash) {
+    // Metadata files are indexed under the file they describe
+    if (filePath.length() > 5 && filePath.substr(filePath.length() - 5) == ".meta") {
+        IndexFile(filePath);
+        return;
+    }
+
+    (*mHashes)[hash] = filePath;
+}
+
 void Archive::Validate() {
 #ifdef ENABLE_SCRIPTING
     if (mManifest.Checksum.empty()) {
@@ -191,7 +326,13 @@ void Archive::Validate() {
     auto manager = Context::GetInstance()->GetResourceManager()->GetArchiveManager();
     std::vector<uint8_t> manifestKey = StringHelper::HexToBytes(mManifest.PublicKey);
 
+    // Archives are loaded concurrently, the keystore and the handler asking the user are not thread safe
+    std::unique_lock<std::mutex> keystoreLock(sKeystoreMutex);
     if (!keystore->HasKey(manifestKey)) {
+        if (mDeferUntrustedPrompt) {
+            mUntrustedPromptPending = true;
+            return;
+        }
         auto callback = manager->GetUntrustedArchiveHandler();
         if (callback != nullptr) {
             auto key = KeystoreEntry{ mManifest.Author, manifestKey, KeyOrigin::User };
@@ -209,41 +350,12 @@ void Archive::Validate() {
         }
     }
 
-    std::vector<std::tuple<std::string, std::shared_ptr<File>>> files;
-
-    for (const auto& [hash, filePath] : *mHashes) {
-        std::string normalizedPath = filePath;
-        std::replace(normalizedPath.begin(), normalizedPath.end(), '\\', '/');
-
-        if (normalizedPath == "manifest.json" || normalizedPath.back() == '/') {
-            continue;
-        }
-
-        auto file = LoadFile(filePath);
-        if (file == nullptr || !file->IsLoaded) {
-            SPDLOG_ERROR("Failed to load file {} from archive {} during validation", filePath, GetPath());
-            return;
-        }
-
-        files.emplace_back(normalizedPath, file);
-    }
-
-    std::sort(files.begin(), files.end(),
-              [](const std::tuple<std::string, std::shared_ptr<File>>& a,
-                 const std::tuple<std::string, std::shared_ptr<File>>& b) { return std::get<0>(a) < std::get<0>(b); });
+    keystoreLock.unlock();
 
-    crypto_blake2b_ctx ctx;
-    crypto_blake2b_init(&ctx, 64);
-
-    for (const auto& [normalizedPath, file] : files) {
-        crypto_blake2b_update(&ctx, reinterpret_cast<const uint8_t*>(normalizedPath.c_str()), normalizedPath.length());
-        if (file->Buffer->size() > 0) {
-            crypto_blake2b_update(&ctx, reinterpret_cast<const uint8_t*>(file->Buffer->data()), file->Buffer->size());
-        }
+    std::vector<uint8_t> rawHash;
+    if (!ComputeChecksum(*this, rawHash)) {
+        return;
     }
-
-    std::vector<uint8_t> rawHash(64);
-    crypto_blake2b_final(&ctx, rawHash.data());
     std::string calculatedChecksumHex = StringHelper::BytesToHex(rawHash);
     if (calculatedChecksumHex != mManifest.Checksum) {
         SPDLOG_ERROR("Checksum validation failed for archive {}. Expected {}, got {}", GetPath(), mManifest.Checksum,
@@ -269,7 +381,13 @@ void Archive::Validate() {
 
     bool validSignature = false;
 
-    for (const auto& key : keystore->GetAllKeys()) {
+    keystoreLock.lock();
+    auto keys = keystore->GetAllKeys();
+    keystoreLock.unlock();
+    // The manifest names the key it was signed with, so that one is tried before the rest
+    std::stable_partition(keys.begin(), keys.end(),
+                          [&manifestKey](const KeystoreEntry& key) { return key.Data == manifestKey; });
+    for (const auto& key : keys) {
         const int status = crypto_ed25519_check(signature.data(), key.Data.data(), rawHash.data(), rawHash.size());
 
         if (status == 0) {
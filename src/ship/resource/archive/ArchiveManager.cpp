@@ -1,8 +1,12 @@
 #include "ship/resource/archive/ArchiveManager.h"
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <thread>
 #include "spdlog/spdlog.h"
 
+#include "ship/resource/Resource.h"
 #include "ship/resource/archive/Archive.h"
 #ifdef INCLUDE_MPQ_SUPPORT
 #include "ship/resource/archive/OtrArchive.h"
@@ -24,12 +28,61 @@ void ArchiveManager::Init(const std::vector<std::string>& archivePaths) {
 void ArchiveManager::Init(const std::vector<std::string>& archivePaths,
                           const std::unordered_set<uint32_t>& validGameVersions) {
     mValidGameVersions = validGameVersions;
-    auto archives = GetArchiveListInPaths(archivePaths);
+    auto archivePathList = GetArchiveListInPaths(archivePaths);
+    std::vector<std::shared_ptr<Archive>> archives;
+    archives.reserve(archivePathList.size());
+    for (const auto& archivePath : archivePathList) {
+        archives.push_back(CreateArchive(archivePath));
+    }
+
+    // Opening and indexing is independent per archive, adding them in list order keeps later archives overriding
+    // earlier ones
+    LoadArchives(archives);
     for (const auto& archive : archives) {
         AddArchive(archive);
     }
 }
 
+void ArchiveManager::LoadArchives(const std::vector<std::shared_ptr<Archive>>& archives) {
+    const size_t threadCount = std::min<size_t>(archives.size(), std::max(1u, std::thread::hardware_concurrency()));
+    if (threadCount <= 1) {
+        for (const auto& archive : archives) {
+            archive->Load();
+        }
+        return;
+    }
+
+    for (const auto& archive : archives) {
+        archive->mDeferUntrustedPrompt = true;
+    }
+    std::atomic<size_t> next = 0;
+    auto loadNext = [&archives, &next]() {
+        for (size_t i = next++; i < archives.size(); i = next++) {
+            archives[i]->Load();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back(loadNext);
+    }
+    loadNext();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // The untrusted archive handler asks the user, so it runs on this thread one archive at a time
+    for (const auto& archive : archives) {
+        archive->mDeferUntrustedPrompt = false;
+        if (archive->mUntrustedPromptPending) {
+            archive->mUntrustedPromptPending = false;
+            if (archive->IsLoaded()) {
+                archive->Validate();
+            }
+        }
+    }
+}
+
 ArchiveManager::~ArchiveManager() {
     SPDLOG_TRACE("destruct archive manager");
     SetArchives(nullptr);
@@ -48,12 +101,13 @@ std::shared_ptr<File> ArchiveManager::LoadFile(const std::string& filePath) {
 }
 
 std::shared_ptr<File> ArchiveManager::LoadFile(uint64_t hash) {
-    auto archive = mFileToArchive[hash];
-    if (archive == nullptr) {
+    // Misses are answered from the index without touching an archive, and must not add entries to it
+    auto archiveFind = mFileToArchive.find(hash);
+    if (archiveFind == mFileToArchive.end() || archiveFind->second == nullptr) {
         return nullptr;
     }
 
-    return archive->LoadFile(hash);
+    return archiveFind->second->LoadFile(hash);
 }
 
 bool ArchiveManager::HasFile(const std::string& filePath) {
@@ -64,8 +118,13 @@ bool ArchiveManager::HasFile(uint64_t hash) {
     return mFileToArchive.count(hash) > 0;
 }
 
+bool ArchiveManager::HasAltAssets() {
+    return mHasAltAssets;
+}
+
 std::shared_ptr<Archive> ArchiveManager::GetArchiveFromFile(const std::string& filePath) {
-    return mFileToArchive[CRC64(filePath.c_str())];
+    auto archiveFind = mFileToArchive.find(CRC64(filePath.c_str()));
+    return archiveFind != mFileToArchive.end() ? archiveFind->second : nullptr;
 }
 
 std::shared_ptr<std::vector<std::string>> ArchiveManager::ListFiles(const std::string& searchMask) {
@@ -143,9 +202,12 @@ void ArchiveManager::ResetVirtualFileSystem() {
     mGameVersions.clear();
     mHashes.clear();
     mFileToArchive.clear();
+    mHasAltAssets = false;
     for (const auto& archive : archives) {
         archive->Unload();
-        archive->Load();
+    }
+    LoadArchives(archives);
+    for (const auto& archive : archives) {
         AddArchive(archive);
     }
 }
@@ -157,6 +219,7 @@ bool ArchiveManager::WriteFile(std::shared_ptr<Archive> archive, const std::stri
             auto hash = CRC64(filePath.c_str());
             mHashes[hash] = filePath;
             mFileToArchive[hash] = archive;
+            mHasAltAssets |= filePath.starts_with(IResource::gAltAssetPrefix);
             return true; // Successfully wrote file
         }
     }
@@ -236,6 +299,12 @@ std::vector<std::string> ArchiveManager::GetArchiveListInPaths(const std::vector
 }
 
 std::shared_ptr<Archive> ArchiveManager::AddArchive(const std::string& archivePath) {
+    auto archive = CreateArchive(archivePath);
+    archive->Load();
+    return AddArchive(archive);
+}
+
+std::shared_ptr<Archive> ArchiveManager::CreateArchive(const std::string& archivePath) {
     const std::filesystem::path path = archivePath;
     const std::string extension = path.extension().string();
     std::shared_ptr<Archive> archive = nullptr;
@@ -256,8 +325,7 @@ std::shared_ptr<Archive> ArchiveManager::AddArchive(const std::string& archivePa
         archive = std::make_shared<O2rArchive>(archivePath);
     }
 
-    archive->Load();
-    return AddArchive(archive);
+    return archive;
 }
 
 std::shared_ptr<Archive> ArchiveManager::AddArchive(std::shared_ptr<Archive> archive) {
@@ -282,6 +350,7 @@ std::shared_ptr<Archive> ArchiveManager::AddArchive(std::shared_ptr<Archive> arc
     for (auto& [hash, filename] : *fileList.get()) {
         mHashes[hash] = filename;
         mFileToArchive[hash] = archive;
+        mHasAltAssets |= filename.starts_with(IResource::gAltAssetPrefix);
 
         size_t lastSlash = filename.find_last_of('/');
         if (lastSlash != std::string::npos) {
@@ -1,11 +1,19 @@
 #include "ship/resource/archive/O2rArchive.h"
 
-#include "ship/Context.h"
+#include "ship/utils/StrHash64.h"
+#include "ship/utils/StringHelper.h"
 #include "ship/window/Window.h"
 #include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
 #include <unordered_map>
 
 namespace Ship {
+static std::string sIndexCacheDirectory;
+
 O2rArchive::O2rArchive(const std::string& archivePath) : Archive(archivePath) {
     mZipArchive = nullptr;
 }
@@ -34,57 +42,441 @@ void O2rArchive::ReleaseZipHandle(zip_t* handle) {
     mZipArchivePool.push_back(handle);
 }
 
+// ZIP structures are little endian and unaligned
+static uint16_t ReadZip16(const uint8_t* data) {
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t ReadZip32(const uint8_t* data) {
+    return (uint32_t)ReadZip16(data) | ((uint32_t)ReadZip16(data + 2) << 16);
+}
+
+static uint64_t ReadZip64(const uint8_t* data) {
+    return (uint64_t)ReadZip32(data) | ((uint64_t)ReadZip32(data + 4) << 32);
+}
+
+#define ZIP_LOCAL_HEADER_SIGNATURE 0x04034b50
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_CENTRAL_HEADER_SIGNATURE 0x02014b50
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_END_SIGNATURE 0x06054b50
+#define ZIP_END_SIZE 22
+#define ZIP64_END_LOCATOR_SIGNATURE 0x07064b50
+#define ZIP64_END_LOCATOR_SIZE 20
+#define ZIP64_END_SIGNATURE 0x06064b50
+#define ZIP64_END_SIZE 56
+#define ZIP64_EXTRA_FIELD_ID 0x0001
+#define ZIP_FLAG_ENCRYPTED 0x0001
+#define ZIP_FLAG_UTF8 0x0800
+#define ZIP_METHOD_STORE 0
+
+// The end of central directory record is followed by a comment of up to 64 KiB
+static bool FindCentralDirectoryEnd(const uint8_t* data, size_t size, size_t& end) {
+    if (size < ZIP_END_SIZE) {
+        return false;
+    }
+
+    end = size - ZIP_END_SIZE;
+    const size_t searchLimit = end > 0xFFFF ? end - 0xFFFF : 0;
+    while (ReadZip32(data + end) != ZIP_END_SIGNATURE) {
+        if (end == searchLimit) {
+            return false;
+        }
+        end--;
+    }
+    return true;
+}
+
+// Covers the end of central directory record with its ZIP64 locator and the archive comment, 0 if there is none
+static uint64_t GetCentralDirectoryEndChecksum(const MappedFile& mapping) {
+    const uint8_t* data = mapping.GetData();
+    const size_t size = mapping.GetSize();
+    size_t end;
+    if (!mapping.IsOpen() || !FindCentralDirectoryEnd(data, size, end)) {
+        return 0;
+    }
+
+    if (end >= ZIP64_END_LOCATOR_SIZE &&
+        ReadZip32(data + end - ZIP64_END_LOCATOR_SIZE) == ZIP64_END_LOCATOR_SIGNATURE) {
+        end -= ZIP64_END_LOCATOR_SIZE;
+    }
+    return crc64(data + end, (uint32_t)(size - end));
+}
+
+bool O2rArchive::ReadCentralDirectory(EntryIndex& index) {
+    const uint8_t* data = index.Mapping->GetData();
+    const size_t size = index.Mapping->GetSize();
+    size_t end;
+    if (!index.Mapping->IsOpen() || !FindCentralDirectoryEnd(data, size, end)) {
+        return false;
+    }
+
+    uint64_t entryCount = ReadZip16(data + end + 10);
+    uint64_t directorySize = ReadZip32(data + end + 12);
+    uint64_t directoryOffset = ReadZip32(data + end + 16);
+    if (end >= ZIP64_END_LOCATOR_SIZE &&
+        ReadZip32(data + end - ZIP64_END_LOCATOR_SIZE) == ZIP64_END_LOCATOR_SIGNATURE) {
+        const uint64_t end64 = ReadZip64(data + end - ZIP64_END_LOCATOR_SIZE + 8);
+        if (size < ZIP64_END_SIZE || end64 > size - ZIP64_END_SIZE || ReadZip32(data + end64) != ZIP64_END_SIGNATURE) {
+            return false;
+        }
+        entryCount = ReadZip64(data + end64 + 32);
+        directorySize = ReadZip64(data + end64 + 40);
+        directoryOffset = ReadZip64(data + end64 + 48);
+    }
+    // Archives with data in front of them (e.g. self extracting ones) are left to libzip
+    if (directoryOffset > size || directorySize > size - directoryOffset) {
+        return false;
+    }
+    // The ZIP64 count is not limited by the record size, a corrupt one must not drive the loop below
+    if (entryCount > directorySize / ZIP_CENTRAL_HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t* record = data + directoryOffset;
+    const uint8_t* directoryEnd = record + directorySize;
+    for (uint64_t i = 0; i < entryCount; i++) {
+        if (directoryEnd - record < ZIP_CENTRAL_HEADER_SIZE || ReadZip32(record) != ZIP_CENTRAL_HEADER_SIGNATURE) {
+            return false;
+        }
+        const uint16_t flags = ReadZip16(record + 8);
+        const uint16_t method = ReadZip16(record + 10);
+        uint64_t compressedSize = ReadZip32(record + 20);
+        uint64_t uncompressedSize = ReadZip32(record + 24);
+        const uint16_t nameLength = ReadZip16(record + 28);
+        const uint16_t extraLength = ReadZip16(record + 30);
+        const uint16_t commentLength = ReadZip16(record + 32);
+        uint64_t localHeaderOffset = ReadZip32(record + 42);
+        const uint8_t* name = record + ZIP_CENTRAL_HEADER_SIZE;
+        const uint8_t* extraEnd = name + nameLength + extraLength;
+        const uint8_t* next = extraEnd + commentLength;
+        if (next > directoryEnd) {
+            return false;
+        }
+        record = next;
+
+        // libzip converts names that are not flagged as UTF-8 from CP437, leave anything that is not plain ASCII to it
+        if ((flags & ZIP_FLAG_UTF8) == 0 && !std::all_of(name, name + nameLength, [](uint8_t c) { return c < 0x80; })) {
+            continue;
+        }
+        // Only fill in entries that libzip lists at the same position under the same name
+        auto entry = index.Entries.find(CRC64(std::string(reinterpret_cast<const char*>(name), nameLength).c_str()));
+        if (entry == index.Entries.end() || entry->second.Index != i) {
+            continue;
+        }
+
+        // Sizes and offsets that don't fit 32 bits are moved to the ZIP64 extra field, in this order
+        for (const uint8_t* extra = name + nameLength; extra + 4 <= extraEnd;) {
+            const uint16_t id = ReadZip16(extra);
+            const uint16_t length = ReadZip16(extra + 2);
+            const uint8_t* field = extra + 4;
+            extra = field + length;
+            if (id != ZIP64_EXTRA_FIELD_ID || extra > extraEnd) {
+                continue;
+            }
+            for (uint64_t* value : { &uncompressedSize, &compressedSize, &localHeaderOffset }) {
+                if (*value == 0xFFFFFFFF && field + 8 <= extra) {
+                    *value = ReadZip64(field);
+                    field += 8;
+                }
+            }
+        }
+
+        entry->second.Size = uncompressedSize;
+        entry->second.CompressedSize = compressedSize;
+        entry->second.LocalHeaderOffset = localHeaderOffset;
+        entry->second.Stored = method == ZIP_METHOD_STORE && (flags & ZIP_FLAG_ENCRYPTED) == 0 &&
+                               compressedSize == uncompressedSize;
+    }
+
+    return true;
+}
+
+std::shared_ptr<const O2rArchive::EntryIndex> O2rArchive::BuildEntryIndex() {
+    auto index = std::make_shared<EntryIndex>();
+
+    auto zipNumEntries = zip_get_num_entries(mZipArchive, 0);
+    index->Entries.reserve(zipNumEntries);
+    for (zip_int64_t i = 0; i < zipNumEntries; i++) {
+        auto zipEntryName = zip_get_name(mZipArchive, i, 0);
+
+        // It is possible for directories to have entries in a zip
+        // file, we don't want those indexed as files in the archive
+        if (zipEntryName[strlen(zipEntryName) - 1] == '/') {
+            continue;
+        }
+
+        index->Entries.emplace(CRC64(zipEntryName), Entry{ (zip_uint64_t)i });
+        IndexFile(zipEntryName);
+    }
+
+    index->Mapping = std::make_unique<MappedFile>(GetPath());
+    if (zipNumEntries > 0 && !ReadCentralDirectory(*index)) {
+        SPDLOG_WARN("Failed to read the central directory of zip file \"{}\", reading entries through libzip",
+                    GetPath());
+    }
+
+    return index;
+}
+
+// Index cache files are little endian like the archives, a header followed by one record per entry:
+// magic, version, archive size, archive modification time, end of central directory checksum, entry count
+// hash, libzip index, size, compressed size, local header offset, stored flag, name length, name
+#define INDEX_CACHE_MAGIC 0x4952324F // "O2RI"
+#define INDEX_CACHE_VERSION 1
+#define INDEX_CACHE_HEADER_SIZE 40
+#define INDEX_CACHE_ENTRY_SIZE 43
+
+static void WriteIndexCacheValue(std::vector<uint8_t>& data, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        data.push_back((uint8_t)(value >> (i * 8)));
+    }
+}
+
+static bool GetModificationTime(const std::string& path, int64_t& modificationTime) {
+    std::error_code error;
+    const auto writeTime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return false;
+    }
+    modificationTime = (int64_t)writeTime.time_since_epoch().count();
+    return true;
+}
+
+void O2rArchive::SetIndexCacheDirectory(const std::string& directory) {
+    sIndexCacheDirectory = directory;
+}
+
+const std::string& O2rArchive::GetIndexCacheDirectory() {
+    return sIndexCacheDirectory;
+}
+
+std::string O2rArchive::GetIndexCachePath() {
+    if (sIndexCacheDirectory.empty()) {
+        return "";
+    }
+
+    // The same archive may be reached through different relative paths
+    std::error_code error;
+    const std::string archivePath = std::filesystem::absolute(GetPath(), error).string();
+    return sIndexCacheDirectory + "/" +
+           StringHelper::Sprintf("%016llX.idx", (unsigned long long)CRC64(archivePath.c_str()));
+}
+
+std::shared_ptr<const O2rArchive::EntryIndex> O2rArchive::LoadIndexCache() {
+    const std::string cachePath = GetIndexCachePath();
+    int64_t modificationTime;
+    if (cachePath.empty() || !GetModificationTime(GetPath(), modificationTime)) {
+        return nullptr;
+    }
+
+    MappedFile cache(cachePath);
+    const uint8_t* data = cache.GetData();
+    const size_t size = cache.GetSize();
+    if (size < INDEX_CACHE_HEADER_SIZE || ReadZip32(data) != INDEX_CACHE_MAGIC ||
+        ReadZip32(data + 4) != INDEX_CACHE_VERSION) {
+        return nullptr;
+    }
+
+    auto index = std::make_shared<EntryIndex>();
+    index->Mapping = std::make_unique<MappedFile>(GetPath());
+    if (ReadZip64(data + 8) != index->Mapping->GetSize() || (int64_t)ReadZip64(data + 16) != modificationTime ||
+        ReadZip64(data + 24) != GetCentralDirectoryEndChecksum(*index->Mapping)) {
+        SPDLOG_DEBUG("Index cache of zip file \"{}\" is out of date", GetPath());
+        return nullptr;
+    }
+
+    // The whole cache is checked before anything is added to the archive's file list
+    const uint64_t entryCount = ReadZip64(data + 32);
+    std::vector<std::pair<std::string_view, uint64_t>> names;
+    names.reserve(std::min<uint64_t>(entryCount, size / INDEX_CACHE_ENTRY_SIZE));
+    index->Entries.reserve(names.capacity());
+    const uint8_t* record = data + INDEX_CACHE_HEADER_SIZE;
+    const uint8_t* cacheEnd = data + size;
+    for (uint64_t i = 0; i < entryCount; i++) {
+        if (cacheEnd - record < INDEX_CACHE_ENTRY_SIZE ||
+            cacheEnd - record - INDEX_CACHE_ENTRY_SIZE < ReadZip16(record + 41)) {
+            SPDLOG_WARN("Index cache of zip file \"{}\" is truncated", GetPath());
+            return nullptr;
+        }
+
+        const uint64_t hash = ReadZip64(record);
+        Entry entry{ ReadZip64(record + 8) };
+        entry.Size = ReadZip64(record + 16);
+        entry.CompressedSize = ReadZip64(record + 24);
+        entry.LocalHeaderOffset = ReadZip64(record + 32);
+        entry.Stored = record[40] != 0;
+        index->Entries.emplace(hash, entry);
+        names.emplace_back(std::string_view(reinterpret_cast<const char*>(record + INDEX_CACHE_ENTRY_SIZE),
+                                            ReadZip16(record + 41)),
+                           hash);
+        record += INDEX_CACHE_ENTRY_SIZE + ReadZip16(record + 41);
+    }
+    if (record != cacheEnd) {
+        SPDLOG_WARN("Index cache of zip file \"{}\" has trailing data", GetPath());
+        return nullptr;
+    }
+
+    for (const auto& [name, hash] : names) {
+        IndexFile(std::string(name), hash);
+    }
+
+    return index;
+}
+
+void O2rArchive::SaveIndexCache(const EntryIndex& index) {
+    const std::string cachePath = GetIndexCachePath();
+    const uint64_t checksum = GetCentralDirectoryEndChecksum(*index.Mapping);
+    int64_t modificationTime;
+    if (cachePath.empty() || checksum == 0 || !GetModificationTime(GetPath(), modificationTime)) {
+        return;
+    }
+
+    std::vector<uint8_t> data;
+    data.reserve(INDEX_CACHE_HEADER_SIZE + index.Entries.size() * (INDEX_CACHE_ENTRY_SIZE + 32));
+    WriteIndexCacheValue(data, INDEX_CACHE_MAGIC, 4);
+    WriteIndexCacheValue(data, INDEX_CACHE_VERSION, 4);
+    WriteIndexCacheValue(data, index.Mapping->GetSize(), 8);
+    WriteIndexCacheValue(data, (uint64_t)modificationTime, 8);
+    WriteIndexCacheValue(data, checksum, 8);
+    WriteIndexCacheValue(data, index.Entries.size(), 8);
+    for (const auto& [hash, entry] : index.Entries) {
+        const char* name = zip_get_name(mZipArchive, entry.Index, 0);
+        const size_t nameLength = name != nullptr ? strlen(name) : SIZE_MAX;
+        if (nameLength > UINT16_MAX) {
+            return;
+        }
+
+        WriteIndexCacheValue(data, hash, 8);
+        WriteIndexCacheValue(data, entry.Index, 8);
+        WriteIndexCacheValue(data, entry.Size, 8);
+        WriteIndexCacheValue(data, entry.CompressedSize, 8);
+        WriteIndexCacheValue(data, entry.LocalHeaderOffset, 8);
+        WriteIndexCacheValue(data, entry.Stored ? 1 : 0, 1);
+        WriteIndexCacheValue(data, nameLength, 2);
+        data.insert(data.end(), name, name + nameLength);
+    }
+
+    // Written next to the cache and renamed over it, so an interrupted write never leaves a partial cache
+    std::error_code error;
+    std::filesystem::create_directories(sIndexCacheDirectory, error);
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+        if (!file) {
+            SPDLOG_WARN("Failed to write index cache of zip file \"{}\" to \"{}\"", GetPath(), tempPath);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error) {
+        SPDLOG_WARN("Failed to write index cache of zip file \"{}\": {}", GetPath(), error.message());
+        std::filesystem::remove(tempPath, error);
+    }
+}
+
+std::shared_ptr<const O2rArchive::EntryIndex> O2rArchive::GetEntryIndex() {
+    std::lock_guard<std::mutex> lock(mPoolMutex);
+    return mEntryIndex;
+}
+
+std::shared_ptr<File> O2rArchive::LoadStoredEntry(const MappedFile& mapping, const Entry& entry) {
+    const uint8_t* data = mapping.GetData();
+    const size_t size = mapping.GetSize();
+    // The local header repeats the name and may have a different extra field than the central directory
+    if (size < ZIP_LOCAL_HEADER_SIZE || entry.LocalHeaderOffset > size - ZIP_LOCAL_HEADER_SIZE ||
+        ReadZip32(data + entry.LocalHeaderOffset) != ZIP_LOCAL_HEADER_SIGNATURE) {
+        return nullptr;
+    }
+    const uint64_t dataOffset = entry.LocalHeaderOffset + ZIP_LOCAL_HEADER_SIZE +
+                                ReadZip16(data + entry.LocalHeaderOffset + 26) +
+                                ReadZip16(data + entry.LocalHeaderOffset + 28);
+    if (dataOffset > size || entry.Size > size - dataOffset) {
+        return nullptr;
+    }
+
+    auto fileToLoad = std::make_shared<File>();
+    fileToLoad->Buffer = std::make_shared<std::vector<char>>(data + dataOffset, data + dataOffset + entry.Size);
+    fileToLoad->IsLoaded = true;
+    return fileToLoad;
+}
+
 std::shared_ptr<File> O2rArchive::LoadFile(uint64_t hash) {
-    const std::string& filePath =
-        *Context::GetInstance()->GetResourceManager()->GetArchiveManager()->HashToString(hash);
-    return LoadFile(filePath);
+    auto index = GetEntryIndex();
+    if (index == nullptr) {
+        SPDLOG_TRACE("Failed to open file {:016X} from zip archive {}. Archive not open.", hash, GetPath());
+        return nullptr;
+    }
+
+    auto entry = index->Entries.find(hash);
+    if (entry == index->Entries.end()) {
+        SPDLOG_TRACE("Failed to find file {:016X} in zip archive {}.", hash, GetPath());
+        return nullptr;
+    }
+
+    return LoadEntry(*index, entry->second, hash);
 }
 
 std::shared_ptr<File> O2rArchive::LoadFile(const std::string& filePath) {
-    zip_t* zipArchive = GetZipHandle();
-    if (zipArchive == nullptr) {
-        SPDLOG_TRACE("Failed to open file {} from zip archive {}. Archive not open.", filePath, GetPath());
+    return LoadFile(CRC64(filePath.c_str()));
+}
+
+std::shared_ptr<File> O2rArchive::LoadEntry(const EntryIndex& index, const Entry& entry, uint64_t hash) {
+    // Filesize 0, no logging needed
+    if (entry.Size == 0) {
         return nullptr;
     }
 
-    auto zipEntryIndex = zip_name_locate(zipArchive, filePath.c_str(), 0);
-    if (zipEntryIndex < 0) {
-        SPDLOG_TRACE("Failed to find file {} in zip archive  {}.", filePath, GetPath());
-        ReleaseZipHandle(zipArchive);
-        return nullptr;
+    if (entry.Stored) {
+        auto fileToLoad = LoadStoredEntry(*index.Mapping, entry);
+        if (fileToLoad != nullptr) {
+            return fileToLoad;
+        }
+        SPDLOG_TRACE("Invalid local header for file {:016X} in zip archive {}.", hash, GetPath());
     }
 
-    struct zip_stat zipEntryStat;
-    zip_stat_init(&zipEntryStat);
-    if (zip_stat_index(zipArchive, zipEntryIndex, 0, &zipEntryStat) != 0) {
-        SPDLOG_TRACE("Failed to get entry information for file {} in zip archive  {}.", filePath, GetPath());
-        ReleaseZipHandle(zipArchive);
+    zip_t* zipArchive = GetZipHandle();
+    if (zipArchive == nullptr) {
+        SPDLOG_TRACE("Failed to open file {:016X} from zip archive {}. Archive not open.", hash, GetPath());
         return nullptr;
     }
 
+    uint64_t size = entry.Size;
+    if (size == UINT64_MAX) {
+        struct zip_stat zipEntryStat;
+        zip_stat_init(&zipEntryStat);
+        if (zip_stat_index(zipArchive, entry.Index, 0, &zipEntryStat) != 0) {
+            SPDLOG_TRACE("Failed to get entry information for file {:016X} in zip archive {}.", hash, GetPath());
+            ReleaseZipHandle(zipArchive);
+            return nullptr;
+        }
+        size = zipEntryStat.size;
+    }
+
     // Filesize 0, no logging needed
-    if (zipEntryStat.size == 0) {
-        SPDLOG_TRACE("Failed to load file {}; filesize 0", filePath, GetPath());
+    if (size == 0) {
+        SPDLOG_TRACE("Failed to load file {:016X}; filesize 0", hash);
         ReleaseZipHandle(zipArchive);
         return nullptr;
     }
 
-    struct zip_file* zipEntryFile = zip_fopen_index(zipArchive, zipEntryIndex, 0);
+    struct zip_file* zipEntryFile = zip_fopen_index(zipArchive, entry.Index, 0);
     if (!zipEntryFile) {
-        SPDLOG_TRACE("Failed to open file {} in zip archive  {}.", filePath, GetPath());
+        SPDLOG_TRACE("Failed to open file {:016X} in zip archive {}.", hash, GetPath());
         ReleaseZipHandle(zipArchive);
         return nullptr;
     }
 
     auto fileToLoad = std::make_shared<File>();
-    fileToLoad->Buffer = std::make_shared<std::vector<char>>(zipEntryStat.size);
+    fileToLoad->Buffer = std::make_shared<std::vector<char>>(size);
 
-    if (zip_fread(zipEntryFile, fileToLoad->Buffer->data(), zipEntryStat.size) < 0) {
-        SPDLOG_TRACE("Error reading file {} in zip archive  {}.", filePath, GetPath());
+    if (zip_fread(zipEntryFile, fileToLoad->Buffer->data(), size) < 0) {
+        SPDLOG_TRACE("Error reading file {:016X} in zip archive {}.", hash, GetPath());
     }
 
     if (zip_fclose(zipEntryFile) != 0) {
-        SPDLOG_TRACE("Error closing file {} in zip archive  {}.", filePath, GetPath());
+        SPDLOG_TRACE("Error closing file {:016X} in zip archive {}.", hash, GetPath());
     }
 
     ReleaseZipHandle(zipArchive);
@@ -95,25 +487,23 @@ std::shared_ptr<File> O2rArchive::LoadFile(const std::string& filePath) {
 }
 
 bool O2rArchive::Open() {
-    mZipArchive = zip_open(GetPath().c_str(), ZIP_CREATE, nullptr);
-    if (mZipArchive == nullptr) {
-        SPDLOG_ERROR("Failed to load zip file \"{}\"", GetPath());
-        return false;
-    }
-
-    auto zipNumEntries = zip_get_num_entries(mZipArchive, 0);
-    for (auto i = 0; i < zipNumEntries; i++) {
-        auto zipEntryName = zip_get_name(mZipArchive, i, 0);
-
-        // It is possible for directories to have entries in a zip
-        // file, we don't want those indexed as files in the archive
-        if (zipEntryName[strlen(zipEntryName) - 1] == '/') {
-            continue;
+    auto index = LoadIndexCache();
+    if (index != nullptr) {
+        SPDLOG_DEBUG("Opened zip file \"{}\" from its index cache", GetPath());
+    } else {
+        mZipArchive = zip_open(GetPath().c_str(), ZIP_CREATE, nullptr);
+        if (mZipArchive == nullptr) {
+            SPDLOG_ERROR("Failed to load zip file \"{}\"", GetPath());
+            return false;
         }
 
-        IndexFile(zipEntryName);
+        index = BuildEntryIndex();
+        SaveIndexCache(*index);
     }
 
+    std::lock_guard<std::mutex> lock(mPoolMutex);
+    mEntryIndex = std::move(index);
+
     return true;
 }
 
@@ -129,6 +519,7 @@ bool O2rArchive::Close() {
     }
 
     std::lock_guard<std::mutex> lock(mPoolMutex);
+    mEntryIndex = nullptr;
     for (auto* handle : mZipArchivePool) {
         if (zip_close(handle) == -1) {
             SPDLOG_ERROR("Failed to close pooled zip file \"{}\"", GetPath());
@@ -141,6 +532,11 @@ bool O2rArchive::Close() {
 }
 
 bool O2rArchive::WriteFile(const std::string& filePath, const std::vector<uint8_t>& data) {
+    // Archives opened from the index cache only open libzip once they are written to
+    if (mZipArchive == nullptr && GetEntryIndex() != nullptr) {
+        mZipArchive = zip_open(GetPath().c_str(), ZIP_CREATE, nullptr);
+    }
+
     if (!mZipArchive) {
         SPDLOG_ERROR("Cannot write to zip: Archive is not open.");
         return false;
@@ -160,6 +556,12 @@ bool O2rArchive::WriteFile(const std::string& filePath, const std::vector<uint8_
         return false;
     }
 
+    // The file is replaced on save, which fails on some platforms while it is mapped
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+        mEntryIndex = nullptr;
+    }
+
     // Save changes to disk
     if (zip_close(mZipArchive) < 0) {
         zip_error_t* error = zip_get_error(mZipArchive);
@@ -187,7 +589,13 @@ bool O2rArchive::WriteFile(const std::string& filePath, const std::vector<uint8_
         return false;
     }
 
-    IndexFile(filePath);
+    // Entries may have moved and libzip may have renumbered them
+    auto index = BuildEntryIndex();
+    SaveIndexCache(*index);
+    {
+        std::lock_guard<std::mutex> lock(mPoolMutex);
+        mEntryIndex = std::move(index);
+    }
 
     // Success
     return true;
@@ -0,0 +1,76 @@
+#include "ship/utils/filesystemtools/MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Ship {
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && (uint64_t)size.QuadPart <= SIZE_MAX) {
+        // The view keeps the mapping and the file open, so both handles can be closed right away
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            mData = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            mSize = mData != nullptr ? (size_t)size.QuadPart : 0;
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0 && (uint64_t)info.st_size <= SIZE_MAX) {
+        void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data != MAP_FAILED) {
+            mData = static_cast<const uint8_t*>(data);
+            mSize = (size_t)info.st_size;
+        }
+    }
+    // The mapping keeps its own reference to the file
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+    if (mData == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(mData);
+#else
+    munmap(const_cast<uint8_t*>(mData), mSize);
+#endif
+}
+
+bool MappedFile::IsOpen() const {
+    return mData != nullptr;
+}
+
+const uint8_t* MappedFile::GetData() const {
+    return mData;
+}
+
+size_t MappedFile::GetSize() const {
+    return mSize;
+}
+
+} // namespace Ship
@@ -1,13 +1,19 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "ship/resource/File.h"
 #include "ship/resource/Resource.h"
+#include "ship/resource/ResourceFactoryBinary.h"
 #include "ship/resource/ResourceManager.h"
 #include "ship/resource/archive/Archive.h"
 #include "ship/resource/archive/ArchiveManager.h"
@@ -80,6 +86,18 @@ class TestRamArchive final : public Ship::Archive {
     }
 };
 
+// Exposes the cache insertion that LoadResource uses, loading resources without init data needs a Context
+class TestResourceManager : public Ship::ResourceManager {
+  public:
+    using Ship::ResourceManager::CacheResource;
+};
+
+std::shared_ptr<Ship::Blob> BlobOfSize(size_t size) {
+    auto blob = std::make_shared<Ship::Blob>();
+    blob->Data.resize(size);
+    return blob;
+}
+
 // Helper: build and load a TestRamArchive with given files
 std::shared_ptr<TestRamArchive> LoadedArchive(const std::string& path,
                                               const std::unordered_map<std::string, std::string>& files) {
@@ -199,6 +217,32 @@ TEST(ArchiveManager, LoadFileMissingReturnsNull) {
     EXPECT_EQ(am.LoadFile("doesnotexist.bin"), nullptr);
 }
 
+TEST(ArchiveManager, LoadFileMissingDoesNotIndexPath) {
+    auto archive = LoadedArchive("ram://test", { { "a.bin", "data" } });
+    Ship::ArchiveManager am;
+    am.AddArchive(archive);
+
+    EXPECT_EQ(am.LoadFile("a.bin.meta"), nullptr);
+    EXPECT_EQ(am.GetArchiveFromFile("alt/a.bin"), nullptr);
+    EXPECT_FALSE(am.HasFile("a.bin.meta"));
+    EXPECT_FALSE(am.HasFile("alt/a.bin"));
+}
+
+TEST(ArchiveManager, HasAltAssetsTracksMountedArchives) {
+    auto base = LoadedArchive("ram://base", { { "textures/hero.bin", "a" } });
+    auto mod = LoadedArchive("ram://mod", { { "alt/textures/hero.bin", "b" } });
+    Ship::ArchiveManager am;
+    am.AddArchive(base);
+    EXPECT_FALSE(am.HasAltAssets());
+
+    am.AddArchive(mod);
+    EXPECT_TRUE(am.HasAltAssets());
+    EXPECT_TRUE(am.HasFile(Ship::IResource::gAltAssetPrefix + "textures/hero.bin"));
+
+    am.RemoveArchive(mod);
+    EXPECT_FALSE(am.HasAltAssets());
+}
+
 TEST(ArchiveManager, LoadFileEmptyPathReturnsNull) {
     Ship::ArchiveManager am;
     EXPECT_EQ(am.LoadFile(""), nullptr);
@@ -730,6 +774,235 @@ TEST(ResourceManager, UnloadResourceByIdentifierIsNoOp) {
     EXPECT_NO_THROW(rm.UnloadResource(id));
 }
 
+// ============================================================
+// ResourceManager — memory budget
+// ============================================================
+
+TEST(ResourceManager, CacheIsUnlimitedByDefault) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+
+    rm.CacheResource({ "a", 0, nullptr }, BlobOfSize(100));
+    rm.CacheResource({ "b", 0, nullptr }, BlobOfSize(100));
+    EXPECT_EQ(rm.GetMemoryBudget(), 0u);
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 200u);
+    EXPECT_NE(rm.GetCachedResource("a"), nullptr);
+    EXPECT_NE(rm.GetCachedResource("b"), nullptr);
+}
+
+TEST(ResourceManager, CacheEvictsLeastRecentlyUsedOverBudget) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+    rm.SetMemoryBudget(250);
+
+    rm.CacheResource({ "a", 0, nullptr }, BlobOfSize(100));
+    rm.CacheResource({ "b", 0, nullptr }, BlobOfSize(100));
+    // Using a makes b the least recently used
+    EXPECT_NE(rm.GetCachedResource("a"), nullptr);
+    rm.CacheResource({ "c", 0, nullptr }, BlobOfSize(100));
+
+    EXPECT_NE(rm.GetCachedResource("a"), nullptr);
+    EXPECT_EQ(rm.GetCachedResource("b"), nullptr);
+    EXPECT_NE(rm.GetCachedResource("c"), nullptr);
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 200u);
+}
+
+TEST(ResourceManager, CacheKeepsReferencedAndPinnedResources) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+
+    auto referenced = rm.CacheResource({ "a", 0, nullptr }, BlobOfSize(100));
+    rm.PinResource("b");
+    rm.CacheResource({ "b", 0, nullptr }, BlobOfSize(100));
+    rm.CacheResource({ "c", 0, nullptr }, BlobOfSize(100));
+    rm.SetMemoryBudget(100);
+
+    // Only c could be evicted
+    EXPECT_NE(rm.GetCachedResource("a"), nullptr);
+    EXPECT_NE(rm.GetCachedResource("b"), nullptr);
+    EXPECT_EQ(rm.GetCachedResource("c"), nullptr);
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 200u);
+
+    referenced = nullptr;
+    EXPECT_TRUE(rm.UnpinResource("b"));
+    EXPECT_FALSE(rm.UnpinResource("b"));
+    EXPECT_LE(rm.GetCachedResourcesSize(), 100u);
+}
+
+TEST(ResourceManager, CacheKeepsResourcesWithSharedRawPointers) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+
+    EXPECT_NE(rm.GetResourceRawPointer(rm.CacheResource({ "a", 0, nullptr }, BlobOfSize(100))), nullptr);
+    rm.CacheResource({ "b", 0, nullptr }, BlobOfSize(100));
+    rm.SetMemoryBudget(100);
+
+    // Nothing tracks the raw pointer, so a stays cached even though nothing else references it
+    EXPECT_NE(rm.GetCachedResource("a"), nullptr);
+    EXPECT_EQ(rm.GetCachedResource("b"), nullptr);
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 100u);
+}
+
+TEST(ResourceManager, CacheRetriesEvictionAfterGrowing) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+    rm.SetMemoryBudget(1600);
+
+    std::vector<std::shared_ptr<Ship::IResource>> referenced;
+    for (int32_t i = 0; i < 21; i++) {
+        referenced.push_back(rm.CacheResource({ "a" + std::to_string(i), 0, nullptr }, BlobOfSize(100)));
+    }
+    referenced.clear();
+
+    // Nothing could be evicted at 2100 bytes, so growing by less than 100 doesn't look again
+    rm.CacheResource({ "b", 0, nullptr }, BlobOfSize(50));
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 2150u);
+
+    rm.CacheResource({ "c", 0, nullptr }, BlobOfSize(100));
+    EXPECT_LE(rm.GetCachedResourcesSize(), 1600u);
+}
+
+TEST(ResourceManager, UnpinningRetriesEviction) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+    rm.SetMemoryBudget(100);
+
+    auto referenced = rm.CacheResource({ "a", 0, nullptr }, BlobOfSize(100));
+    rm.PinResource("b");
+    rm.CacheResource({ "b", 0, nullptr }, BlobOfSize(100));
+    referenced = nullptr;
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 200u);
+
+    EXPECT_TRUE(rm.UnpinResource("b"));
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 0u);
+}
+
+TEST(ResourceManager, UnloadResourceReleasesItsSize) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+
+    rm.CacheResource({ "a", 0, nullptr }, BlobOfSize(100));
+    EXPECT_EQ(rm.UnloadResource("a"), 1u);
+    EXPECT_EQ(rm.GetCachedResourcesSize(), 0u);
+    EXPECT_EQ(rm.GetCachedResource("a"), nullptr);
+}
+
+TEST(ResourceManager, CacheAccountingHoldsUnderConcurrentUse) {
+    TestResourceManager rm;
+    rm.Init({}, {});
+    rm.SetMemoryBudget(1000);
+
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < 4; t++) {
+        threads.emplace_back([&rm, t]() {
+            for (int32_t i = 0; i < 500; i++) {
+                const std::string path = "res/" + std::to_string((i * 7 + t) % 64);
+                if (rm.GetCachedResource(path) == nullptr) {
+                    rm.CacheResource({ path, 0, nullptr }, BlobOfSize(100));
+                }
+                if (i % 50 == 0) {
+                    rm.UnloadResource(path);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Resources the threads still used during the last evictions are evicted now
+    rm.SetMemoryBudget(1000);
+    EXPECT_LE(rm.GetCachedResourcesSize(), 1000u);
+    size_t cached = 0;
+    for (int32_t i = 0; i < 64; i++) {
+        cached += rm.GetCachedResource("res/" + std::to_string(i)) != nullptr ? 100 : 0;
+    }
+    EXPECT_EQ(cached, rm.GetCachedResourcesSize());
+}
+
+TEST(ResourceManager, LoadResourcesBatchLoadsEveryMatchingFile) {
+    const auto dir = std::filesystem::temp_directory_path() / "lus_batch_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "textures");
+    for (int32_t i = 0; i < 32; i++) {
+        std::ofstream(dir / "textures" / (std::to_string(i) + ".bin")) << "x";
+    }
+    std::ofstream(dir / "other.bin") << "x";
+
+    TestResourceManager rm;
+    rm.Init({ dir.string() }, {});
+    ASSERT_TRUE(rm.IsLoaded());
+    // Cached resources are returned without going through the resource loader
+    std::unordered_map<std::string, std::shared_ptr<Ship::IResource>> cached;
+    auto files = rm.GetArchiveManager()->ListFiles();
+    for (const auto& path : *files) {
+        cached[path] = rm.CacheResource({ path, 0, nullptr }, BlobOfSize(1));
+    }
+
+    auto batch = rm.LoadResourcesBatch("textures/*");
+    auto resources = batch->GetFuture().get();
+    ASSERT_EQ(batch->GetFileCount(), 32u);
+    EXPECT_TRUE(batch->IsDone());
+    EXPECT_EQ(batch->GetLoadedCount(), 32u);
+    EXPECT_FLOAT_EQ(batch->GetProgress(), 1.0f);
+    ASSERT_EQ(resources->size(), 32u);
+    for (size_t i = 0; i < resources->size(); i++) {
+        EXPECT_EQ((*resources)[i], cached[batch->GetFiles()[i]]);
+        EXPECT_EQ(batch->GetResource(i).get(), (*resources)[i]);
+    }
+
+    auto empty = rm.LoadResourcesBatch("missing/*");
+    EXPECT_TRUE(empty->IsDone());
+    EXPECT_FLOAT_EQ(empty->GetProgress(), 1.0f);
+    EXPECT_TRUE(empty->GetFuture().get()->empty());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ResourceManager, ConcurrentLoadsOfOneResourceReadItOnce) {
+    // Counts the reads and holds each one long enough for the other loads to find it in flight
+    class CountingFactory final : public Ship::ResourceFactoryBinary {
+      public:
+        std::shared_ptr<Ship::IResource> ReadResource(std::shared_ptr<Ship::File> file,
+                                                      std::shared_ptr<Ship::ResourceInitData> initData) override {
+            Reads++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return BlobOfSize(1);
+        }
+
+        std::atomic<int32_t> Reads = 0;
+    };
+
+    TestResourceManager rm;
+    rm.Init({}, {});
+    rm.GetArchiveManager()->AddArchive(LoadedArchive("ram://test", { { "counted.bin", "x" } }));
+    auto factory = std::make_shared<CountingFactory>();
+    const uint32_t type = 0x434E5431; // CNT1
+    ASSERT_TRUE(rm.GetResourceLoader()->RegisterResourceFactory(factory, RESOURCE_FORMAT_BINARY, "Counted", type, 0));
+    auto initData = std::make_shared<Ship::ResourceInitData>();
+    initData->Path = "counted.bin";
+    initData->ByteOrder = Ship::Endianness::Native;
+    initData->Type = type;
+    initData->ResourceVersion = 0;
+    initData->Format = RESOURCE_FORMAT_BINARY;
+
+    constexpr size_t kLoaders = 8;
+    std::vector<std::shared_ptr<Ship::IResource>> loaded(kLoaders);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kLoaders; i++) {
+        threads.emplace_back([&, i] { loaded[i] = rm.LoadResource("counted.bin", true, initData); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(factory->Reads, 1);
+    ASSERT_NE(loaded[0], nullptr);
+    for (const auto& resource : loaded) {
+        EXPECT_EQ(resource, loaded[0]);
+    }
+}
+
 // ============================================================
 // ResourceFilter — construction
 // ============================================================
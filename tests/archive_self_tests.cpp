@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -6,6 +9,7 @@
 
 #include "ship/resource/File.h"
 #include "ship/resource/archive/Archive.h"
+#include "ship/resource/archive/O2rArchive.h"
 #include "ship/utils/StrHash64.h"
 
 // ============================================================
@@ -225,3 +229,345 @@ TEST(Archive, IsChecksumValidFalseWhenNotSigned) {
     arch.Load();
     EXPECT_FALSE(arch.IsChecksumValid());
 }
+
+// ============================================================
+// O2rArchive — hand written ZIP files, so the tests control the layout
+// ============================================================
+
+namespace {
+
+struct ZipEntry {
+    std::string Name;
+    std::string Data;
+    bool Deflate = false;
+};
+
+void Put16(std::vector<uint8_t>& out, uint64_t value) {
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+}
+
+void Put32(std::vector<uint8_t>& out, uint64_t value) {
+    Put16(out, value);
+    Put16(out, value >> 16);
+}
+
+void Put64(std::vector<uint8_t>& out, uint64_t value) {
+    Put32(out, value);
+    Put32(out, value >> 32);
+}
+
+void PutString(std::vector<uint8_t>& out, const std::string& value) {
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+uint32_t Crc32(const std::string& data) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint8_t c : data) {
+        crc ^= c;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Deflated entries use a single uncompressed deflate block, which keeps them readable only through libzip
+std::string DeflateStored(const std::string& data) {
+    std::vector<uint8_t> block = { 0x01 };
+    Put16(block, data.size());
+    Put16(block, ~data.size());
+    PutString(block, data);
+    return std::string(block.begin(), block.end());
+}
+
+std::vector<uint8_t> BuildZip(const std::vector<ZipEntry>& entries, bool zip64 = false,
+                              const std::string& comment = "") {
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> directory;
+    const uint16_t version = zip64 ? 45 : 20;
+    for (const auto& entry : entries) {
+        const std::string data = entry.Deflate ? DeflateStored(entry.Data) : entry.Data;
+        const uint64_t offset = out.size();
+        const uint16_t method = entry.Deflate ? 8 : 0;
+
+        Put32(out, 0x04034b50);
+        Put16(out, version);
+        Put16(out, 0);
+        Put16(out, method);
+        Put32(out, 0);
+        Put32(out, Crc32(entry.Data));
+        Put32(out, zip64 ? 0xFFFFFFFF : data.size());
+        Put32(out, zip64 ? 0xFFFFFFFF : entry.Data.size());
+        Put16(out, entry.Name.size());
+        Put16(out, zip64 ? 20 : 0);
+        PutString(out, entry.Name);
+        if (zip64) {
+            Put16(out, 0x0001);
+            Put16(out, 16);
+            Put64(out, entry.Data.size());
+            Put64(out, data.size());
+        }
+        PutString(out, data);
+
+        Put32(directory, 0x02014b50);
+        Put16(directory, version);
+        Put16(directory, version);
+        Put16(directory, 0);
+        Put16(directory, method);
+        Put32(directory, 0);
+        Put32(directory, Crc32(entry.Data));
+        Put32(directory, zip64 ? 0xFFFFFFFF : data.size());
+        Put32(directory, zip64 ? 0xFFFFFFFF : entry.Data.size());
+        Put16(directory, entry.Name.size());
+        Put16(directory, zip64 ? 28 : 0);
+        Put16(directory, 0);
+        Put16(directory, 0);
+        Put16(directory, 0);
+        Put32(directory, 0);
+        Put32(directory, zip64 ? 0xFFFFFFFF : offset);
+        PutString(directory, entry.Name);
+        if (zip64) {
+            Put16(directory, 0x0001);
+            Put16(directory, 24);
+            Put64(directory, entry.Data.size());
+            Put64(directory, data.size());
+            Put64(directory, offset);
+        }
+    }
+
+    const uint64_t directoryOffset = out.size();
+    out.insert(out.end(), directory.begin(), directory.end());
+    if (zip64) {
+        const uint64_t end64 = out.size();
+        Put32(out, 0x06064b50);
+        Put64(out, 44);
+        Put16(out, version);
+        Put16(out, version);
+        Put32(out, 0);
+        Put32(out, 0);
+        Put64(out, entries.size());
+        Put64(out, entries.size());
+        Put64(out, directory.size());
+        Put64(out, directoryOffset);
+
+        Put32(out, 0x07064b50);
+        Put32(out, 0);
+        Put64(out, end64);
+        Put32(out, 1);
+    }
+    Put32(out, 0x06054b50);
+    Put16(out, 0);
+    Put16(out, 0);
+    Put16(out, zip64 ? 0xFFFF : entries.size());
+    Put16(out, zip64 ? 0xFFFF : entries.size());
+    Put32(out, zip64 ? 0xFFFFFFFF : directory.size());
+    Put32(out, zip64 ? 0xFFFFFFFF : directoryOffset);
+    Put16(out, comment.size());
+    PutString(out, comment);
+    return out;
+}
+
+class O2rArchiveTest : public ::testing::Test {
+  protected:
+    std::filesystem::path mTestDir;
+
+    void SetUp() override {
+        mTestDir = std::filesystem::temp_directory_path() / "lus_o2r_archive_test";
+        std::filesystem::remove_all(mTestDir);
+        std::filesystem::create_directories(mTestDir);
+    }
+
+    void TearDown() override {
+        Ship::O2rArchive::SetIndexCacheDirectory("");
+        std::filesystem::remove_all(mTestDir);
+    }
+
+    std::string EnableIndexCache() {
+        const std::string directory = (mTestDir / "cache").string();
+        Ship::O2rArchive::SetIndexCacheDirectory(directory);
+        return directory;
+    }
+
+    std::filesystem::path GetIndexCacheFile() {
+        for (const auto& file : std::filesystem::directory_iterator(mTestDir / "cache")) {
+            if (file.path().extension() == ".idx") {
+                return file.path();
+            }
+        }
+        return {};
+    }
+
+    // Backdates the cache, a cache that is rewritten gets a current modification time again
+    std::filesystem::file_time_type BackdateIndexCache() {
+        const auto time = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+        std::filesystem::last_write_time(GetIndexCacheFile(), time);
+        return time;
+    }
+
+    std::string WriteArchive(const std::vector<uint8_t>& data, const std::string& name = "test.o2r") {
+        const std::string path = (mTestDir / name).string();
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        return path;
+    }
+
+    static std::string Read(Ship::O2rArchive& archive, const std::string& path) {
+        auto file = archive.LoadFile(path);
+        if (file == nullptr || file->Buffer == nullptr) {
+            return "<missing>";
+        }
+        return std::string(file->Buffer->begin(), file->Buffer->end());
+    }
+};
+
+const std::vector<ZipEntry> sEntries = {
+    { "textures/a.bin", "stored entry" },
+    { "textures/b.bin", std::string(3000, 'b'), true },
+    { "objects/c.bin", "another stored entry" },
+};
+
+} // anonymous namespace
+
+TEST_F(O2rArchiveTest, ReadsStoredEntries) {
+    Ship::O2rArchive archive(WriteArchive(BuildZip({ sEntries[0], sEntries[2] })));
+    ASSERT_TRUE(archive.Open());
+    EXPECT_EQ(Read(archive, "textures/a.bin"), sEntries[0].Data);
+    EXPECT_EQ(Read(archive, "objects/c.bin"), sEntries[2].Data);
+    EXPECT_EQ(Read(archive, "textures/missing.bin"), "<missing>");
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, ReadsDeflatedEntries) {
+    Ship::O2rArchive archive(WriteArchive(BuildZip(sEntries)));
+    ASSERT_TRUE(archive.Open());
+    EXPECT_EQ(Read(archive, "textures/b.bin"), sEntries[1].Data);
+    EXPECT_EQ(Read(archive, "textures/a.bin"), sEntries[0].Data);
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, ReadsZip64Archive) {
+    Ship::O2rArchive archive(WriteArchive(BuildZip(sEntries, true)));
+    ASSERT_TRUE(archive.Open());
+    for (const auto& entry : sEntries) {
+        EXPECT_EQ(Read(archive, entry.Name), entry.Data) << entry.Name;
+    }
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, ReadsArchiveWithComment) {
+    Ship::O2rArchive archive(WriteArchive(BuildZip(sEntries, false, std::string(1000, 'c'))));
+    ASSERT_TRUE(archive.Open());
+    for (const auto& entry : sEntries) {
+        EXPECT_EQ(Read(archive, entry.Name), entry.Data) << entry.Name;
+    }
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, TruncatedArchiveDoesNotOpen) {
+    auto data = BuildZip(sEntries);
+    data.resize(data.size() / 2);
+    Ship::O2rArchive archive(WriteArchive(data));
+    EXPECT_FALSE(archive.Open());
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, IndexCacheRoundTrip) {
+    EnableIndexCache();
+    const std::string path = WriteArchive(BuildZip(sEntries));
+    {
+        Ship::O2rArchive archive(path);
+        ASSERT_TRUE(archive.Open());
+        archive.Close();
+    }
+    ASSERT_FALSE(GetIndexCacheFile().empty());
+    const auto cacheTime = BackdateIndexCache();
+
+    Ship::O2rArchive archive(path);
+    ASSERT_TRUE(archive.Open());
+    EXPECT_EQ(std::filesystem::last_write_time(GetIndexCacheFile()), cacheTime);
+    for (const auto& entry : sEntries) {
+        EXPECT_TRUE(archive.HasFile(entry.Name)) << entry.Name;
+        EXPECT_EQ(Read(archive, entry.Name), entry.Data) << entry.Name;
+    }
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, IndexCacheIgnoredWhenSizeChanges) {
+    EnableIndexCache();
+    const std::string path = WriteArchive(BuildZip({ sEntries[0], sEntries[1] }));
+    {
+        Ship::O2rArchive archive(path);
+        ASSERT_TRUE(archive.Open());
+        archive.Close();
+    }
+    const auto cacheTime = BackdateIndexCache();
+    const auto archiveTime = std::filesystem::last_write_time(path);
+    WriteArchive(BuildZip(sEntries));
+    std::filesystem::last_write_time(path, archiveTime);
+
+    Ship::O2rArchive archive(path);
+    ASSERT_TRUE(archive.Open());
+    EXPECT_NE(std::filesystem::last_write_time(GetIndexCacheFile()), cacheTime);
+    EXPECT_EQ(Read(archive, sEntries[2].Name), sEntries[2].Data);
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, IndexCacheIgnoredWhenModificationTimeChanges) {
+    EnableIndexCache();
+    const std::string path = WriteArchive(BuildZip(sEntries));
+    {
+        Ship::O2rArchive archive(path);
+        ASSERT_TRUE(archive.Open());
+        archive.Close();
+    }
+    const auto cacheTime = BackdateIndexCache();
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) - std::chrono::minutes(5));
+
+    Ship::O2rArchive archive(path);
+    ASSERT_TRUE(archive.Open());
+    EXPECT_NE(std::filesystem::last_write_time(GetIndexCacheFile()), cacheTime);
+    EXPECT_EQ(Read(archive, sEntries[0].Name), sEntries[0].Data);
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, IndexCacheIgnoredWhenCentralDirectoryEndChanges) {
+    EnableIndexCache();
+    const std::string path = WriteArchive(BuildZip(sEntries, false, "first"));
+    {
+        Ship::O2rArchive archive(path);
+        ASSERT_TRUE(archive.Open());
+        archive.Close();
+    }
+    const auto cacheTime = BackdateIndexCache();
+    // Same size and modification time, only the comment after the end record differs
+    const auto archiveTime = std::filesystem::last_write_time(path);
+    WriteArchive(BuildZip(sEntries, false, "other"));
+    std::filesystem::last_write_time(path, archiveTime);
+
+    Ship::O2rArchive archive(path);
+    ASSERT_TRUE(archive.Open());
+    EXPECT_NE(std::filesystem::last_write_time(GetIndexCacheFile()), cacheTime);
+    archive.Close();
+}
+
+TEST_F(O2rArchiveTest, TruncatedIndexCacheIsRebuilt) {
+    EnableIndexCache();
+    const std::string path = WriteArchive(BuildZip(sEntries));
+    {
+        Ship::O2rArchive archive(path);
+        ASSERT_TRUE(archive.Open());
+        archive.Close();
+    }
+    const auto cacheFile = GetIndexCacheFile();
+    std::filesystem::resize_file(cacheFile, std::filesystem::file_size(cacheFile) - 10);
+    const auto cacheTime = BackdateIndexCache();
+
+    Ship::O2rArchive archive(path);
+    ASSERT_TRUE(archive.Open());
+    EXPECT_NE(std::filesystem::last_write_time(GetIndexCacheFile()), cacheTime);
+    for (const auto& entry : sEntries) {
+        EXPECT_EQ(Read(archive, entry.Name), entry.Data) << entry.Name;
+    }
+    archive.Close();
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "ship/config/Config.h"
+
+namespace fs = std::filesystem;
+
+class ConfigSaveTest : public ::testing::Test {
+  protected:
+    fs::path mTestDir;
+    fs::path mConfigPath;
+
+    void SetUp() override {
+        mTestDir = fs::temp_directory_path() / "lus_config_test";
+        fs::remove_all(mTestDir);
+        fs::create_directories(mTestDir);
+        mConfigPath = mTestDir / "config.json";
+    }
+
+    void TearDown() override {
+        fs::remove_all(mTestDir);
+    }
+
+    nlohmann::json ReadConfigFile() {
+        std::ifstream file(mConfigPath);
+        return nlohmann::json::parse(file);
+    }
+};
+
+TEST_F(ConfigSaveTest, FlushWritesPendingSave) {
+    Ship::Config config(mConfigPath.string());
+    config.SetInt("Window.Width", 640);
+    config.Save();
+    config.Flush();
+
+    EXPECT_EQ(ReadConfigFile()["Window"]["Width"], 640);
+    // The temporary file was renamed over the config
+    EXPECT_FALSE(fs::exists(mConfigPath.string() + ".tmp"));
+}
+
+TEST_F(ConfigSaveTest, SavesWithinDelayAreCoalesced) {
+    Ship::Config config(mConfigPath.string());
+    config.SetSaveDelay(std::chrono::seconds(10));
+    for (int32_t i = 0; i < 10; i++) {
+        config.SetInt("Value", i);
+        config.Save();
+    }
+    EXPECT_FALSE(fs::exists(mConfigPath));
+
+    config.Flush();
+    EXPECT_EQ(ReadConfigFile()["Value"], 9);
+}
+
+TEST_F(ConfigSaveTest, SaveUsesValuesAtTimeOfRequest) {
+    Ship::Config config(mConfigPath.string());
+    config.SetSaveDelay(std::chrono::seconds(10));
+    config.SetInt("Value", 1);
+    config.Save();
+    config.SetInt("Value", 2);
+    config.Flush();
+
+    EXPECT_EQ(ReadConfigFile()["Value"], 1);
+}
+
+TEST_F(ConfigSaveTest, ReloadReadsPendingSave) {
+    Ship::Config config(mConfigPath.string());
+    config.SetSaveDelay(std::chrono::seconds(10));
+    config.SetInt("Value", 5);
+    config.Save();
+    config.Reload();
+
+    EXPECT_EQ(config.GetInt("Value"), 5);
+}
+
+TEST_F(ConfigSaveTest, DestructorWritesPendingSave) {
+    {
+        Ship::Config config(mConfigPath.string());
+        config.SetSaveDelay(std::chrono::seconds(10));
+        config.SetString("Name", "test");
+        config.Save();
+    }
+
+    EXPECT_EQ(ReadConfigFile()["Name"], "test");
+    EXPECT_EQ(Ship::Config(mConfigPath.string()).GetString("Name", ""), "test");
+}
+
+TEST_F(ConfigSaveTest, IncrementalSaveMatchesFullSerialization) {
+    Ship::Config config(mConfigPath.string());
+    config.SetSaveDelay(std::chrono::milliseconds(0));
+    config.SetInt("ConfigVersion", 2);
+    config.SetInt("CVars.gAudio.Volume", 80);
+    config.SetString("CVars.gAudioBackend", "sdl");
+    config.SetInt("CVars.gSettings.Nested.Value", 1);
+    config.SetInt("Recent.0", 640);
+    config.SetInt("Recent.1", 480);
+    config.Save();
+
+    // Each save only reserializes the touched blocks
+    config.SetInt("CVars.gAudio.Volume", 50);
+    config.Erase("CVars.gAudioBackend");
+    config.SetFloat("Window.Scale", 1.5f);
+    config.SetInt("Recent.1", 720);
+    config.Save();
+    config.Flush();
+
+    std::ifstream file(mConfigPath);
+    const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, config.GetNestedJson().dump(4));
+    EXPECT_EQ(ReadConfigFile()["CVars"]["gAudio"]["Volume"], 50);
+    EXPECT_FALSE(ReadConfigFile()["CVars"].contains("gAudioBackend"));
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ship/config/Config.h"
+#include "ship/config/ConsoleVariable.h"
+
+namespace fs = std::filesystem;
+
+class ConsoleVariableTest : public ::testing::Test {
+  protected:
+    fs::path mTestDir;
+    std::shared_ptr<Ship::Config> mConfig;
+    std::shared_ptr<Ship::ConsoleVariable> mCVars;
+
+    void SetUp() override {
+        mTestDir = fs::temp_directory_path() / "lus_console_variable_test";
+        fs::remove_all(mTestDir);
+        fs::create_directories(mTestDir);
+        mConfig = std::make_shared<Ship::Config>((mTestDir / "config.json").string());
+        mCVars = std::make_shared<Ship::ConsoleVariable>(mConfig);
+    }
+
+    void TearDown() override {
+        mCVars = nullptr;
+        mConfig = nullptr;
+        fs::remove_all(mTestDir);
+    }
+};
+
+TEST_F(ConsoleVariableTest, RegisterOnlySetsAbsentVariables) {
+    mCVars->RegisterInteger("gValue", 3);
+    EXPECT_EQ(mCVars->GetInteger("gValue", 0), 3);
+
+    mCVars->SetInteger("gValue", 5);
+    mCVars->RegisterInteger("gValue", 3);
+    EXPECT_EQ(mCVars->GetInteger("gValue", 0), 5);
+
+    mCVars->RegisterString("gName", "default");
+    mCVars->RegisterString("gName", "other");
+    EXPECT_STREQ(mCVars->GetString("gName", ""), "default");
+}
+
+TEST_F(ConsoleVariableTest, CallbackFiresOnChangeAndClear) {
+    std::vector<int32_t> values;
+    mCVars->RegisterChangeCallback("gValue", [&](const char* name, const Ship::CVar* variable) {
+        EXPECT_STREQ(name, "gValue");
+        values.push_back(variable != nullptr ? variable->Integer : -1);
+    });
+
+    mCVars->RegisterInteger("gValue", 1);
+    mCVars->RegisterInteger("gValue", 2);
+    mCVars->SetInteger("gValue", 4);
+    mCVars->ClearVariable("gValue");
+
+    EXPECT_EQ(values, std::vector<int32_t>({ 1, 4, -1 }));
+}
+
+TEST_F(ConsoleVariableTest, SettingSameValueDoesNotFire) {
+    int32_t fired = 0;
+    mCVars->RegisterChangeCallback("gName", [&](const char*, const Ship::CVar*) { fired++; });
+
+    mCVars->SetString("gName", "value");
+    const uint64_t sequence = mCVars->GetChangeSequence();
+    const std::string same = "value";
+    mCVars->SetString("gName", same.c_str());
+
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(mCVars->GetChangeSequence(), sequence);
+
+    // Same bits under another type is a change
+    mCVars->SetInteger("gName", 0);
+    EXPECT_EQ(fired, 2);
+}
+
+TEST_F(ConsoleVariableTest, ChangeSequenceAdvancesOnEveryChange) {
+    uint64_t sequence = mCVars->GetChangeSequence();
+
+    mCVars->SetFloat("gScale", 1.5f);
+    EXPECT_GT(mCVars->GetChangeSequence(), sequence);
+    sequence = mCVars->GetChangeSequence();
+
+    mCVars->CopyVariable("gScale", "gScaleCopy");
+    EXPECT_GT(mCVars->GetChangeSequence(), sequence);
+    EXPECT_EQ(mCVars->GetFloat("gScaleCopy", 0.0f), 1.5f);
+    sequence = mCVars->GetChangeSequence();
+
+    mCVars->ClearVariable("gScale");
+    EXPECT_GT(mCVars->GetChangeSequence(), sequence);
+    sequence = mCVars->GetChangeSequence();
+
+    mCVars->CopyVariable("gMissing", "gScale");
+    EXPECT_EQ(mCVars->GetChangeSequence(), sequence);
+}
+
+TEST_F(ConsoleVariableTest, UnregisteringDuringCallbackIsSafe) {
+    int32_t firstFired = 0;
+    int32_t secondFired = 0;
+    uint32_t firstId = 0;
+    uint32_t secondId = 0;
+    firstId = mCVars->RegisterChangeCallback("gValue", [&](const char*, const Ship::CVar*) {
+        firstFired++;
+        mCVars->UnregisterChangeCallback(firstId);
+        mCVars->UnregisterChangeCallback(secondId);
+    });
+    secondId = mCVars->RegisterChangeCallback("gValue", [&](const char*, const Ship::CVar*) { secondFired++; });
+
+    // Callbacks unregistered while a change is being fired still see that change
+    mCVars->SetInteger("gValue", 1);
+    EXPECT_EQ(firstFired, 1);
+    EXPECT_EQ(secondFired, 1);
+
+    mCVars->SetInteger("gValue", 2);
+    EXPECT_EQ(firstFired, 1);
+    EXPECT_EQ(secondFired, 1);
+}
+
+TEST_F(ConsoleVariableTest, CallbackValueOutlivesClearByEarlierCallback) {
+    std::string seen;
+    mCVars->RegisterChangeCallback("gName", [&](const char* name, const Ship::CVar* variable) {
+        if (variable != nullptr) {
+            mCVars->ClearVariable(name);
+        }
+    });
+    mCVars->RegisterChangeCallback("gName", [&](const char*, const Ship::CVar* variable) {
+        if (variable != nullptr) {
+            seen = variable->String;
+        }
+    });
+
+    mCVars->SetString("gName", "value");
+
+    EXPECT_EQ(seen, "value");
+    EXPECT_EQ(mCVars->Get("gName"), nullptr);
+}
+
+TEST_F(ConsoleVariableTest, LoadFiresClearedForRemovedVariables) {
+    mCVars->SetInteger("gSaved", 7);
+    mCVars->Save();
+    mCVars->SetInteger("gUnsaved", 8);
+
+    std::vector<std::string> cleared;
+    std::vector<std::string> changed;
+    auto record = [&](const char* name, const Ship::CVar* variable) {
+        (variable != nullptr ? changed : cleared).push_back(name);
+    };
+    mCVars->RegisterChangeCallback("gSaved", record);
+    mCVars->RegisterChangeCallback("gUnsaved", record);
+
+    mCVars->Load();
+
+    EXPECT_EQ(cleared, std::vector<std::string>({ "gUnsaved" }));
+    EXPECT_EQ(changed, std::vector<std::string>({ "gSaved" }));
+    EXPECT_EQ(mCVars->GetInteger("gSaved", 0), 7);
+    EXPECT_EQ(mCVars->Get("gUnsaved"), nullptr);
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "fast/FrameLimiter.h"
+
+using Fast::FrameJitterHistogram;
+using Fast::FrameLimiter;
+
+// ============================================================
+// Histogram
+// ============================================================
+
+TEST(FrameJitterHistogram, BucketsRoundToNearest) {
+    const size_t zero = FrameJitterHistogram::BUCKET_COUNT / 2;
+    EXPECT_EQ(FrameJitterHistogram::GetBucketIndex(0), zero);
+    EXPECT_EQ(FrameJitterHistogram::GetBucketIndex(40000), zero);
+    EXPECT_EQ(FrameJitterHistogram::GetBucketIndex(60000), zero + 1);
+    EXPECT_EQ(FrameJitterHistogram::GetBucketIndex(-60000), zero - 1);
+    EXPECT_EQ(FrameJitterHistogram::GetBucketCenter(zero + 3), 300000);
+    EXPECT_EQ(FrameJitterHistogram::GetBucketCenter(0), -2000000);
+}
+
+TEST(FrameJitterHistogram, OuterBucketsCollectOutliers) {
+    FrameJitterHistogram histogram;
+    histogram.Record(50000000);
+    histogram.Record(-50000000);
+    EXPECT_EQ(histogram.GetBucket(FrameJitterHistogram::BUCKET_COUNT - 1), 1u);
+    EXPECT_EQ(histogram.GetBucket(0), 1u);
+    EXPECT_EQ(histogram.GetMaxAbsolute(), 50000000);
+}
+
+TEST(FrameJitterHistogram, Statistics) {
+    FrameJitterHistogram histogram;
+    histogram.Record(100000);
+    histogram.Record(-100000);
+    histogram.Record(300000);
+    histogram.Record(-300000);
+
+    EXPECT_EQ(histogram.GetCount(), 4u);
+    EXPECT_DOUBLE_EQ(histogram.GetMean(), 0.0);
+    EXPECT_NEAR(histogram.GetStandardDeviation(), 223606.8, 0.1);
+    EXPECT_EQ(histogram.GetMaxAbsolute(), 300000);
+
+    histogram.Reset();
+    EXPECT_EQ(histogram.GetCount(), 0u);
+    EXPECT_EQ(histogram.GetBucket(FrameJitterHistogram::BUCKET_COUNT / 2 + 1), 0u);
+    EXPECT_DOUBLE_EQ(histogram.GetStandardDeviation(), 0.0);
+}
+
+// ============================================================
+// Limiter
+// ============================================================
+
+// Simulated clock, every read advances it by a microsecond and sleeps wake up the given latency after the deadline
+class SimulatedFrameLimiter : public FrameLimiter {
+  public:
+    int64_t mTime = 1000000000;
+    int64_t mWakeLatency = 0;
+    uint32_t mSleeps = 0;
+
+  protected:
+    int64_t ReadClock() override {
+        mTime += 1000;
+        return mTime;
+    }
+
+    void SleepUntil(int64_t deadline, int64_t now) override {
+        if (deadline > now) {
+            mTime = std::max(mTime, deadline + mWakeLatency);
+            mSleeps++;
+        }
+    }
+};
+
+TEST(FrameLimiter, PacesToTargetRate) {
+    SimulatedFrameLimiter limiter;
+    limiter.Wait(100);
+    const int64_t start = limiter.mTime;
+    for (int i = 0; i < 10; i++) {
+        limiter.Wait(100);
+    }
+
+    // Ten 10 ms intervals, overshooting only by the spin steps
+    EXPECT_GE(limiter.mTime - start, 100000000);
+    EXPECT_LT(limiter.mTime - start, 100000000 + 10 * 2000);
+    EXPECT_EQ(limiter.mSleeps, 10u);
+    EXPECT_EQ(limiter.GetJitterHistogram().GetCount(), 10u);
+    EXPECT_LT(limiter.GetJitterHistogram().GetMaxAbsolute(), FrameJitterHistogram::BUCKET_WIDTH_NS / 2);
+}
+
+TEST(FrameLimiter, SlowWakeUpKeepsSchedule) {
+    SimulatedFrameLimiter limiter;
+    limiter.SetSpinMargin(0);
+    limiter.mWakeLatency = 500000;
+    limiter.Wait(100);
+    const int64_t start = limiter.mTime;
+    for (int i = 0; i < 10; i++) {
+        limiter.Wait(100);
+    }
+
+    // Each frame wakes up late, but the deadlines stay 10 ms apart so the lateness does not add up
+    EXPECT_GE(limiter.mTime - start, 100000000);
+    EXPECT_LT(limiter.mTime - start, 100000000 + 500000 + 10 * 2000);
+}
+
+TEST(FrameLimiter, LateFrameStartsNewSchedule) {
+    SimulatedFrameLimiter limiter;
+    limiter.SetSpinMargin(0);
+    limiter.Wait(100);
+    limiter.mTime += 30000000;
+    limiter.Wait(100);
+    const int64_t late = limiter.mTime;
+    limiter.Wait(100);
+
+    // The missed frames are not made up for by returning early
+    EXPECT_GE(limiter.mTime - late, 10000000);
+    EXPECT_EQ(limiter.GetJitterHistogram().GetBucket(FrameJitterHistogram::BUCKET_COUNT - 1), 1u);
+}
+
+TEST(FrameLimiter, TargetChangeIsNotRecorded) {
+    SimulatedFrameLimiter limiter;
+    limiter.SetSpinMargin(0);
+    limiter.Wait(500);
+    limiter.Wait(500);
+    limiter.Wait(250);
+    EXPECT_EQ(limiter.GetJitterHistogram().GetCount(), 1u);
+
+    limiter.ResetJitterHistogram();
+    EXPECT_EQ(limiter.GetJitterHistogram().GetCount(), 0u);
+    EXPECT_EQ(limiter.GetSpinMargin(), 0);
+}
+
+TEST(FrameLimiter, RealClockNeverReturnsEarly) {
+    FrameLimiter limiter;
+    const int64_t start = FrameLimiter::Now();
+    limiter.Wait(1000);
+    const int64_t first = FrameLimiter::Now();
+    limiter.Wait(1000);
+    const int64_t second = FrameLimiter::Now();
+
+    EXPECT_GE(first, start);
+    EXPECT_GE(second - start, 1000000);
+}
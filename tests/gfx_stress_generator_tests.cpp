@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "fast/debug/GfxStressGenerator.h"
+
+using Fast::F3DGfx;
+using Fast::GfxStressConfig;
+using Fast::GfxStressGenerator;
+using Fast::GfxStressWorkload;
+
+namespace {
+
+int8_t Opcode(const F3DGfx& cmd) {
+    return (int8_t)(cmd.words.w0 >> 24);
+}
+
+size_t CountOpcode(const std::vector<F3DGfx>& list, int8_t opcode) {
+    size_t count = 0;
+    for (const F3DGfx& cmd : list) {
+        count += Opcode(cmd) == opcode;
+    }
+    return count;
+}
+
+GfxStressConfig SmallConfig() {
+    GfxStressConfig config;
+    config.objectCount = 8;
+    config.textureCount = 4;
+    return config;
+}
+
+} // namespace
+
+// ============================================================
+// Determinism
+// ============================================================
+
+TEST(GfxStressGenerator, SameSeedProducesSameWorkload) {
+    auto a = GfxStressGenerator(SmallConfig()).Generate();
+    auto b = GfxStressGenerator(SmallConfig()).Generate();
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+
+    // Display list words only hold opcodes and segmented addresses, so they compare equal across workloads
+    const auto& listA = a->GetDisplayListArena();
+    const auto& listB = b->GetDisplayListArena();
+    ASSERT_EQ(listA.size(), listB.size());
+    for (size_t i = 0; i < listA.size(); i++) {
+        EXPECT_EQ(listA[i].words.w0, listB[i].words.w0);
+        EXPECT_EQ(listA[i].words.w1, listB[i].words.w1);
+    }
+    EXPECT_EQ(a->GetStats().triangles, b->GetStats().triangles);
+    EXPECT_EQ(a->GetStats().segmentBytes, b->GetStats().segmentBytes);
+}
+
+TEST(GfxStressGenerator, SeedChangesWorkload) {
+    GfxStressConfig config = SmallConfig();
+    auto a = GfxStressGenerator(config).Generate();
+    config.seed = 2;
+    auto b = GfxStressGenerator(config).Generate();
+
+    const auto& listA = a->GetDisplayListArena();
+    const auto& listB = b->GetDisplayListArena();
+    bool differs = listA.size() != listB.size();
+    for (size_t i = 0; !differs && i < listA.size(); i++) {
+        differs = listA[i].words.w0 != listB[i].words.w0;
+    }
+    EXPECT_TRUE(differs);
+}
+
+// ============================================================
+// Structure
+// ============================================================
+
+TEST(GfxStressGenerator, ListsAreTerminated) {
+    auto workload = GfxStressGenerator(SmallConfig()).Generate();
+    const auto& stats = workload->GetStats();
+
+    EXPECT_EQ(Opcode(workload->GetRootCommands().back()), Fast::F3DEX2_G_ENDDL);
+    EXPECT_EQ(Opcode(workload->GetDisplayListArena().back()), Fast::F3DEX2_G_ENDDL);
+    // Every generated list plus the root ends in exactly one G_ENDDL
+    EXPECT_EQ(CountOpcode(workload->GetDisplayListArena(), Fast::F3DEX2_G_ENDDL) + 1, stats.displayLists);
+    EXPECT_EQ(CountOpcode(workload->GetRootCommands(), Fast::F3DEX2_G_DL), 8u);
+}
+
+TEST(GfxStressGenerator, NestingStopsAtMaxDepth) {
+    GfxStressConfig config = SmallConfig();
+    config.maxNestingDepth = 3;
+    config.nestingProbability = 1.0f;
+    auto nested = GfxStressGenerator(config).Generate();
+    EXPECT_EQ(nested->GetStats().maxDepth, 3u);
+
+    config.maxNestingDepth = 0;
+    auto flat = GfxStressGenerator(config).Generate();
+    EXPECT_EQ(flat->GetStats().maxDepth, 0u);
+    EXPECT_EQ(CountOpcode(flat->GetDisplayListArena(), Fast::F3DEX2_G_DL), 0u);
+}
+
+TEST(GfxStressGenerator, StatsMatchEmittedCommands) {
+    GfxStressConfig config = SmallConfig();
+    config.texRectDensity = 0.5f;
+    auto workload = GfxStressGenerator(config).Generate();
+    const auto& arena = workload->GetDisplayListArena();
+    const auto& stats = workload->GetStats();
+
+    size_t vertices = 0;
+    for (const F3DGfx& cmd : arena) {
+        if (Opcode(cmd) == Fast::F3DEX2_G_VTX) {
+            vertices += (cmd.words.w0 >> 12) & 0xFF;
+        }
+    }
+    EXPECT_EQ(vertices, stats.vertices);
+    EXPECT_EQ(CountOpcode(arena, Fast::F3DEX2_G_TRI1) + 2 * CountOpcode(arena, Fast::F3DEX2_G_TRI2),
+              stats.triangles);
+    EXPECT_EQ(CountOpcode(arena, Fast::RDP_G_TEXRECT), stats.texRects);
+    EXPECT_EQ(CountOpcode(arena, Fast::RDP_G_SETCOMBINE), stats.stateChanges);
+    EXPECT_EQ(stats.commands, arena.size() + workload->GetRootCommands().size());
+}
+
+TEST(GfxStressGenerator, TexRectDensityBounds) {
+    GfxStressConfig config = SmallConfig();
+    config.texRectDensity = 0.0f;
+    EXPECT_EQ(GfxStressGenerator(config).Generate()->GetStats().texRects, 0u);
+
+    config.texRectDensity = 1.0f;
+    auto workload = GfxStressGenerator(config).Generate();
+    EXPECT_EQ(workload->GetStats().texRects, workload->GetStats().stateChanges);
+}
+
+TEST(GfxStressGenerator, BackgroundsSwitchUcode) {
+    GfxStressConfig config = SmallConfig();
+    config.backgroundCount = 2;
+    auto workload = GfxStressGenerator(config).Generate();
+    const auto& root = workload->GetRootCommands();
+
+    EXPECT_EQ(workload->GetStats().backgrounds, 2u);
+    EXPECT_EQ(CountOpcode(root, Fast::F3DEX2_G_LOAD_UCODE), 2u);
+    EXPECT_EQ(CountOpcode(root, Fast::F3DEX2_G_BG_1CYC), 1u);
+    EXPECT_EQ(CountOpcode(root, Fast::F3DEX2_G_BG_COPY), 1u);
+}
+
+TEST(GfxStressGenerator, OversizedWorkloadIsRejected) {
+    GfxStressConfig config = SmallConfig();
+    config.backgroundCount = 128;
+    EXPECT_EQ(GfxStressGenerator(config).Generate(), nullptr);
+}
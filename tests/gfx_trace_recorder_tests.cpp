@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "fast/debug/GfxTraceRecorder.h"
+
+namespace fs = std::filesystem;
+using Fast::GfxTraceEntry;
+using Fast::GfxTraceRecorder;
+
+// ============================================================
+// Ring buffer
+// ============================================================
+
+TEST(GfxTraceRecorder, CapacityRoundsUpToPowerOfTwo) {
+    GfxTraceRecorder trace(100);
+    EXPECT_EQ(trace.GetCapacity(), 128u);
+}
+
+TEST(GfxTraceRecorder, DisabledByDefault) {
+    GfxTraceRecorder trace(8);
+    EXPECT_FALSE(trace.IsEnabled());
+    trace.SetEnabled(true);
+    EXPECT_TRUE(trace.IsEnabled());
+}
+
+TEST(GfxTraceRecorder, SnapshotKeepsRecordOrder) {
+    GfxTraceRecorder trace(8);
+    trace.Record(0x01, 0, 0x01000000, 0x10, 1);
+    trace.Record(0x06, 0, 0x06000000, 0x20, 2);
+
+    auto entries = trace.Snapshot();
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].opcode, 0x01);
+    EXPECT_EQ(entries[0].w1, 0x10u);
+    EXPECT_EQ(entries[0].depth, 1);
+    EXPECT_EQ(entries[1].opcode, 0x06);
+    EXPECT_EQ(entries[1].depth, 2);
+    EXPECT_LE(entries[0].timestamp, entries[1].timestamp);
+}
+
+TEST(GfxTraceRecorder, WrapKeepsNewestEntries) {
+    GfxTraceRecorder trace(4);
+    for (int i = 0; i < 10; i++) {
+        trace.Record((int8_t)i, 0, i, i, 0);
+    }
+
+    EXPECT_EQ(trace.GetRecordedCount(), 10u);
+    auto entries = trace.Snapshot();
+    ASSERT_EQ(entries.size(), 4u);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(entries[i].opcode, 6 + i);
+    }
+}
+
+TEST(GfxTraceRecorder, ClearDropsEntries) {
+    GfxTraceRecorder trace(4);
+    trace.Record(0x01, 0, 0, 0, 0);
+    trace.Clear();
+    EXPECT_TRUE(trace.Snapshot().empty());
+}
+
+TEST(GfxTraceRecorder, ClearKeepsRecordingAfterWrap) {
+    GfxTraceRecorder trace(4);
+    for (int i = 0; i < 6; i++) {
+        trace.Record((int8_t)i, 0, i, i, 0);
+    }
+    trace.Clear();
+    trace.Record(0x10, 0, 0, 0, 0);
+
+    EXPECT_EQ(trace.GetRecordedCount(), 1u);
+    auto entries = trace.Snapshot();
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].opcode, 0x10);
+}
+
+TEST(GfxTraceRecorder, SnapshotSkipsEntriesBeingWritten) {
+    GfxTraceRecorder trace(64);
+    std::atomic<bool> done = false;
+
+    // Every producer writes entries whose words match, a torn entry would mix two of them
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; p++) {
+        producers.emplace_back([&trace, p]() {
+            for (uint32_t i = 0; i < 20000; i++) {
+                const uintptr_t word = (uintptr_t)p << 32 | i;
+                trace.Record((int8_t)p, (uint8_t)p, word, word, p);
+            }
+        });
+    }
+    std::thread reader([&]() {
+        while (!done) {
+            for (const GfxTraceEntry& entry : trace.Snapshot()) {
+                ASSERT_EQ(entry.w0, entry.w1);
+                ASSERT_EQ((uint64_t)entry.opcode, entry.w0 >> 32);
+                ASSERT_EQ(entry.depth, entry.opcode);
+                ASSERT_EQ(entry.ucode, entry.opcode);
+            }
+        }
+    });
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(trace.GetRecordedCount(), 80000u);
+}
+
+// ============================================================
+// Dump / Load
+// ============================================================
+
+TEST(GfxTraceRecorder, DumpLoadRoundTrip) {
+    GfxTraceRecorder trace(16);
+    trace.Record((int8_t)0xDE, 2, 0xDE000000, 0x12345678, 3);
+    trace.Record((int8_t)0xDF, 2, 0xDF000000, 0, 2);
+
+    const fs::path path = fs::temp_directory_path() / "lus_gbi_trace_test.bin";
+    ASSERT_TRUE(trace.Dump(path.string()));
+
+    std::vector<GfxTraceEntry> loaded;
+    ASSERT_TRUE(GfxTraceRecorder::Load(path.string(), loaded));
+    fs::remove(path);
+
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[0].opcode, (int8_t)0xDE);
+    EXPECT_EQ(loaded[0].ucode, 2);
+    EXPECT_EQ(loaded[0].w1, 0x12345678u);
+    EXPECT_EQ(loaded[0].depth, 3);
+    EXPECT_EQ(loaded[1].opcode, (int8_t)0xDF);
+}
+
+TEST(GfxTraceRecorder, LoadRejectsForeignFile) {
+    const fs::path path = fs::temp_directory_path() / "lus_gbi_trace_bad.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "not a trace file at all, definitely not";
+    }
+
+    std::vector<GfxTraceEntry> loaded;
+    EXPECT_FALSE(GfxTraceRecorder::Load(path.string(), loaded));
+    fs::remove(path);
+}
@@ -0,0 +1,186 @@
+// Runs generated display lists through the interpreter with the null backends and reports its throughput.
+//
+//   gfxstress [--frames N] [--seed N] [--objects N] [--vertices A:B] [--tris A:B] [--states A:B]
+//             [--tex-size A:B] [--formats rgba16,ci4,...] [--textures N] [--combiners N] [--depth N]
+//             [--nest-prob P] [--texrect-density P] [--backgrounds N]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "fast/backends/gfx_null.h"
+#include "fast/debug/GfxDebugger.h"
+#include "fast/debug/GfxStressGenerator.h"
+#include "fast/interpreter.h"
+#include "ship/Context.h"
+
+using namespace Fast;
+
+namespace {
+
+const std::unordered_map<std::string_view, GfxStressTextureFormat> sFormats = {
+    { "rgba16", { G_IM_FMT_RGBA, G_IM_SIZ_16b } }, { "rgba32", { G_IM_FMT_RGBA, G_IM_SIZ_32b } },
+    { "ci4", { G_IM_FMT_CI, G_IM_SIZ_4b } },       { "ci8", { G_IM_FMT_CI, G_IM_SIZ_8b } },
+    { "ia4", { G_IM_FMT_IA, G_IM_SIZ_4b } },       { "ia8", { G_IM_FMT_IA, G_IM_SIZ_8b } },
+    { "ia16", { G_IM_FMT_IA, G_IM_SIZ_16b } },     { "i4", { G_IM_FMT_I, G_IM_SIZ_4b } },
+    { "i8", { G_IM_FMT_I, G_IM_SIZ_8b } },
+};
+
+bool ParseUint(std::string_view value, uint32_t& out) {
+    char* end = nullptr;
+    const std::string str(value);
+    const unsigned long parsed = strtoul(str.c_str(), &end, 10);
+    if (str.empty() || *end != '\0') {
+        return false;
+    }
+    out = (uint32_t)parsed;
+    return true;
+}
+
+bool ParseFloat(std::string_view value, float& out) {
+    char* end = nullptr;
+    const std::string str(value);
+    out = strtof(str.c_str(), &end);
+    return !str.empty() && *end == '\0';
+}
+
+// "A:B", or "A" for a fixed value
+bool ParseRange(std::string_view value, GfxStressRange& out) {
+    const size_t sep = value.find(':');
+    if (sep == std::string_view::npos) {
+        return ParseUint(value, out.min) && ParseUint(value, out.max);
+    }
+    return ParseUint(value.substr(0, sep), out.min) && ParseUint(value.substr(sep + 1), out.max);
+}
+
+bool ParseFormats(std::string_view value, std::vector<GfxStressTextureFormat>& out) {
+    out.clear();
+    while (!value.empty()) {
+        const size_t sep = value.find(',');
+        auto it = sFormats.find(value.substr(0, sep));
+        if (it == sFormats.end()) {
+            return false;
+        }
+        out.push_back(it->second);
+        value = sep == std::string_view::npos ? std::string_view() : value.substr(sep + 1);
+    }
+    return !out.empty();
+}
+
+bool ParseArgs(int argc, char** argv, GfxStressConfig& config, uint32_t& frames) {
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return false;
+        }
+        const std::string_view value = argv[++i];
+
+        bool ok;
+        if (arg == "--frames") {
+            ok = ParseUint(value, frames);
+        } else if (arg == "--seed") {
+            ok = ParseUint(value, config.seed);
+        } else if (arg == "--objects") {
+            ok = ParseUint(value, config.objectCount);
+        } else if (arg == "--vertices") {
+            ok = ParseRange(value, config.verticesPerLoad);
+        } else if (arg == "--tris") {
+            ok = ParseRange(value, config.trianglesPerStateChange);
+        } else if (arg == "--states") {
+            ok = ParseRange(value, config.stateChangesPerList);
+        } else if (arg == "--tex-size") {
+            ok = ParseRange(value, config.textureSize);
+        } else if (arg == "--formats") {
+            ok = ParseFormats(value, config.textureFormats);
+        } else if (arg == "--textures") {
+            ok = ParseUint(value, config.textureCount);
+        } else if (arg == "--combiners") {
+            ok = ParseUint(value, config.combinerCount);
+        } else if (arg == "--depth") {
+            ok = ParseUint(value, config.maxNestingDepth);
+        } else if (arg == "--nest-prob") {
+            ok = ParseFloat(value, config.nestingProbability);
+        } else if (arg == "--texrect-density") {
+            ok = ParseFloat(value, config.texRectDensity);
+        } else if (arg == "--backgrounds") {
+            ok = ParseUint(value, config.backgroundCount);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i - 1]);
+            return false;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "Invalid value for %s: %s\n", argv[i - 1], argv[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    GfxStressConfig config;
+    uint32_t frames = 300;
+    if (!ParseArgs(argc, argv, config, frames)) {
+        return EXIT_FAILURE;
+    }
+
+    auto workload = GfxStressGenerator(config).Generate();
+    if (workload == nullptr) {
+        fprintf(stderr, "Workload does not fit the segment memory\n");
+        return EXIT_FAILURE;
+    }
+
+    // The interpreter reads its settings through the context, the resource manager is needed for the OTR texture
+    // signature check even though no archive is loaded.
+    auto context = Ship::Context::CreateUninitializedInstance("gfxstress", "gfxstress", "gfxstress.json");
+    if (!context->InitLogging(spdlog::level::warn, spdlog::level::warn) || !context->InitConfiguration() ||
+        !context->InitConsoleVariables() || !context->InitResourceManager({}, {}, 1, true)) {
+        fprintf(stderr, "Failed to initialize the context\n");
+        return EXIT_FAILURE;
+    }
+
+    GfxWindowBackendNull wapi;
+    GfxRenderingAPINull rapi;
+    auto gfx = std::make_shared<Interpreter>();
+    gfx->SetGfxDebugger(std::make_shared<GfxDebugger>());
+    gfx->Init(&wapi, &rapi, "gfxstress", false, 640, 480, 0, 0);
+
+    const std::unordered_map<Mtx*, MtxF> mtxReplacements;
+    auto runFrame = [&]() {
+        gfx->StartFrame();
+        gfx->Run(reinterpret_cast<Gfx*>(workload->GetRootDisplayList()), mtxReplacements);
+        gfx->EndFrame();
+    };
+
+    // The first frame fills the texture and shader caches
+    runFrame();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < frames; i++) {
+        runFrame();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const GfxStressStats& stats = workload->GetStats();
+    printf("workload: %zu commands, %zu lists (depth %u), %zu vertices, %zu triangles, %zu texrects, "
+           "%zu state changes, %zu backgrounds, %zu KiB segment data\n",
+           stats.commands, stats.displayLists, stats.maxDepth, stats.vertices, stats.triangles, stats.texRects,
+           stats.stateChanges, stats.backgrounds, stats.segmentBytes / 1024);
+    printf("backend:  %zu draw calls, %zu triangles, %zu texture uploads per frame\n", rapi.GetDrawCallCount(),
+           rapi.GetTriangleCount(), rapi.GetTextureUploadCount());
+    if (frames > 0) {
+        printf("%u frames in %.3f s: %.1f us/frame, %.2f M commands/s\n", frames, seconds, seconds * 1e6 / frames,
+               stats.commands * (double)frames / seconds / 1e6);
+    }
+
+    gfx->Destroy();
+    return EXIT_SUCCESS;
+}